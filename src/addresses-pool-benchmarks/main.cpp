@@ -0,0 +1,1376 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <iterator>
+#include <iostream>
+#include <limits>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "address_allocator.h"
+#include "batch_diff.h"
+#include "cidr.h"
+#include "concurrent_pool.h"
+#include "diff_stats.h"
+#include "flat_pool.h"
+#include "ipv4_pools.h"
+#include "ipv6_pools.h"
+#include "lazy_diff.h"
+#include "normalized_pool.h"
+#include "parallel_diff.h"
+#include "persistent_pool.h"
+#include "pool_algebra.h"
+#include "pmr_pools.h"
+#include "pool_diff_tracker.h"
+#include "pool_changes.h"
+#include "pool_classifier.h"
+#include "pool_file.h"
+#include "pool_index.h"
+#include "pool_text.h"
+#include "pool_updates.h"
+#include "roaring_pool.h"
+
+
+// Global allocations are counted, so every benchmark can report
+// how much memory `find_diff` requests from the heap per call.
+namespace
+{
+    std::atomic<std::uint64_t> allocated_bytes{0};
+    std::atomic<std::uint64_t> allocations_count{0};
+}
+
+
+void* operator new(std::size_t size)
+{
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    allocations_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* const ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+
+namespace
+{
+    using namespace netup_tt;
+
+
+    // Shapes of the pools being compared
+    enum class Shape
+    {
+        // Long ranges with random starts, each one intersects lots of its neighbours
+        heavy_overlap,
+        // Groups of ranges, where small ranges are nested into a big one
+        nested,
+        // Ranges of old and new pools don't intersect and go one after another
+        disjoint_interleaving,
+        // Old pool is 2000 times bigger than new one (like in randomized tests)
+        lopsided,
+        // Same as `lopsided`, but the old pool is reduced, so it may be galloped over
+        lopsided_reduced
+    };
+
+
+    struct PoolsPair
+    {
+        std::vector<Range> old_ranges;
+        std::vector<Range> new_ranges;
+    };
+
+
+    constexpr std::uint64_t addresses_count = std::uint64_t{std::numeric_limits<IPAddress>::max()} + 1;
+
+
+    std::vector<Range> makeOverlappingRanges(std::mt19937& gen, const std::size_t ranges_count)
+    {
+        const std::uint64_t mean_gap = std::max<std::uint64_t>(1, addresses_count / (ranges_count + 1));
+        std::uniform_int_distribution<std::uint64_t> length_distribution(1, 8 * mean_gap);
+
+        std::vector<Range> ranges;
+        ranges.reserve(ranges_count);
+        for (std::size_t i = 0; i < ranges_count; ++i)
+        {
+            const std::uint64_t length = length_distribution(gen);
+            std::uniform_int_distribution<std::uint64_t> start_distribution(0, addresses_count - length);
+            const std::uint64_t start = start_distribution(gen);
+            ranges.emplace_back(
+                static_cast<IPAddress>(start),
+                static_cast<IPAddress>(start + length - 1)
+            );
+        }
+        return ranges;
+    }
+
+
+    std::vector<Range> makeNestedRanges(const std::size_t ranges_count, const std::uint64_t offset)
+    {
+        // Every group is one outer range and `inner_count` ranges inside of it
+        constexpr std::size_t inner_count = 7;
+        const std::size_t groups_count = (ranges_count + inner_count) / (inner_count + 1);
+        const std::uint64_t group_step = addresses_count / groups_count;
+        const std::uint64_t inner_step = group_step / (inner_count + 2);
+
+        std::vector<Range> ranges;
+        ranges.reserve(ranges_count);
+        for (std::size_t group = 0; group < groups_count && ranges.size() < ranges_count; ++group)
+        {
+            const std::uint64_t group_start = group * group_step + offset * inner_step / 2;
+            ranges.emplace_back(
+                static_cast<IPAddress>(group_start),
+                static_cast<IPAddress>(group_start + (inner_count + 1) * inner_step)
+            );
+            for (std::size_t inner = 1; inner <= inner_count && ranges.size() < ranges_count; ++inner)
+            {
+                const std::uint64_t inner_start = group_start + inner * inner_step;
+                ranges.emplace_back(
+                    static_cast<IPAddress>(inner_start),
+                    static_cast<IPAddress>(inner_start + inner_step / 2)
+                );
+            }
+        }
+        return ranges;
+    }
+
+
+    std::vector<Range> makeInterleavedRanges(const std::size_t ranges_count, const std::uint64_t offset)
+    {
+        // Ranges of two pools with offsets 0 and 1 go one after another and never intersect
+        const std::uint64_t step = std::max<std::uint64_t>(4, addresses_count / (2 * ranges_count));
+
+        std::vector<Range> ranges;
+        ranges.reserve(ranges_count);
+        for (std::size_t i = 0; i < ranges_count; ++i)
+        {
+            const std::uint64_t start = (2 * i + offset) * step;
+            ranges.emplace_back(
+                static_cast<IPAddress>(start),
+                static_cast<IPAddress>(start + step - 2)
+            );
+        }
+        return ranges;
+    }
+
+
+    PoolsPair makePools(const Shape shape, const std::size_t ranges_count)
+    {
+        std::mt19937 gen(9055234);
+
+        switch (shape)
+        {
+        case Shape::heavy_overlap:
+            return {makeOverlappingRanges(gen, ranges_count), makeOverlappingRanges(gen, ranges_count)};
+        case Shape::nested:
+            return {makeNestedRanges(ranges_count, 0), makeNestedRanges(ranges_count, 1)};
+        case Shape::disjoint_interleaving:
+            return {makeInterleavedRanges(ranges_count, 0), makeInterleavedRanges(ranges_count, 1)};
+        case Shape::lopsided:
+            return {
+                makeOverlappingRanges(gen, ranges_count),
+                makeOverlappingRanges(gen, std::max<std::size_t>(1, ranges_count / 2000))
+            };
+        case Shape::lopsided_reduced:
+            return {
+                makeInterleavedRanges(ranges_count, 0),
+                makeInterleavedRanges(std::max<std::size_t>(1, ranges_count / 2000), 1)
+            };
+        }
+        return {};
+    }
+
+
+    class AllocationsCounter
+    {
+    public:
+        AllocationsCounter()
+            : start_bytes_(allocated_bytes.load(std::memory_order_relaxed))
+            , start_count_(allocations_count.load(std::memory_order_relaxed))
+        {
+        }
+
+        void report(benchmark::State& state) const
+        {
+            const auto bytes = allocated_bytes.load(std::memory_order_relaxed) - start_bytes_;
+            const auto count = allocations_count.load(std::memory_order_relaxed) - start_count_;
+            state.counters["bytes_allocated"] = benchmark::Counter(
+                static_cast<double>(bytes), benchmark::Counter::kAvgIterations, benchmark::Counter::kIs1024
+            );
+            state.counters["allocations"] = benchmark::Counter(
+                static_cast<double>(count), benchmark::Counter::kAvgIterations
+            );
+        }
+
+    private:
+        const std::uint64_t start_bytes_;
+        const std::uint64_t start_count_;
+    };
+
+
+    void reportPerRange(benchmark::State& state, const PoolsPair& pools)
+    {
+        // Time per one input range (in seconds, so "12n" means 12 ns/range)
+        state.counters["time_per_range"] = benchmark::Counter(
+            static_cast<double>(pools.old_ranges.size() + pools.new_ranges.size()),
+            benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert
+        );
+    }
+
+
+    template <Shape shape>
+    void BM_FindDiffPool(benchmark::State& state)
+    {
+        const auto pools = makePools(shape, static_cast<std::size_t>(state.range(0)));
+        const Pool old_pool(pools.old_ranges.cbegin(), pools.old_ranges.cend());
+        const Pool new_pool(pools.new_ranges.cbegin(), pools.new_ranges.cend());
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            auto diff = find_diff(old_pool, new_pool);
+            benchmark::DoNotOptimize(diff);
+        }
+        allocations.report(state);
+        reportPerRange(state, pools);
+    }
+
+
+    // What dashboards did before `diff_stats`: the diff is built only to be counted
+    template <Shape shape>
+    void BM_FindDiffThenCount(benchmark::State& state)
+    {
+        const auto pools = makePools(shape, static_cast<std::size_t>(state.range(0)));
+        const Pool old_pool(pools.old_ranges.cbegin(), pools.old_ranges.cend());
+        const Pool new_pool(pools.new_ranges.cbegin(), pools.new_ranges.cend());
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            std::uint64_t addresses_count = 0;
+            for (const auto& [first, last] : find_diff(old_pool, new_pool))
+            {
+                addresses_count += std::uint64_t{last} - first + 1;
+            }
+            benchmark::DoNotOptimize(addresses_count);
+        }
+        allocations.report(state);
+        reportPerRange(state, pools);
+    }
+
+
+    template <Shape shape>
+    void BM_DiffStats(benchmark::State& state)
+    {
+        const auto pools = makePools(shape, static_cast<std::size_t>(state.range(0)));
+        const Pool old_pool(pools.old_ranges.cbegin(), pools.old_ranges.cend());
+        const Pool new_pool(pools.new_ranges.cbegin(), pools.new_ranges.cend());
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            auto stats = diff_stats(old_pool, new_pool);
+            benchmark::DoNotOptimize(stats);
+        }
+        allocations.report(state);
+        reportPerRange(state, pools);
+    }
+
+
+    // Counts and a histogram of /16 networks in the same merge (the histogram is cleared on every call)
+    template <Shape shape>
+    void BM_DiffStatsHistogram(benchmark::State& state)
+    {
+        const auto pools = makePools(shape, static_cast<std::size_t>(state.range(0)));
+        const Pool old_pool(pools.old_ranges.cbegin(), pools.old_ranges.cend());
+        const Pool new_pool(pools.new_ranges.cbegin(), pools.new_ranges.cend());
+        std::vector<std::uint64_t> histogram(65536);
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            auto stats = diff_stats(old_pool, new_pool, 16, histogram);
+            benchmark::DoNotOptimize(stats);
+            benchmark::DoNotOptimize(histogram.data());
+        }
+        allocations.report(state);
+        reportPerRange(state, pools);
+    }
+
+
+    // The first range of diff which is big enough, found in the whole diff
+    template <Shape shape>
+    void BM_FindDiffFirstFit(benchmark::State& state)
+    {
+        const auto pools = makePools(shape, static_cast<std::size_t>(state.range(0)));
+        const Pool old_pool(pools.old_ranges.cbegin(), pools.old_ranges.cend());
+        const Pool new_pool(pools.new_ranges.cbegin(), pools.new_ranges.cend());
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            const Pool diff = find_diff(old_pool, new_pool);
+            auto iter = std::find_if(diff.cbegin(), diff.cend(), [](const Range& range) { return range.second > range.first; });
+            benchmark::DoNotOptimize(iter);
+        }
+        allocations.report(state);
+        reportPerRange(state, pools);
+    }
+
+
+    // The same, but diff is found only as far as the range
+    template <Shape shape>
+    void BM_LazyDiffFirstFit(benchmark::State& state)
+    {
+        const auto pools = makePools(shape, static_cast<std::size_t>(state.range(0)));
+        const Pool old_pool(pools.old_ranges.cbegin(), pools.old_ranges.cend());
+        const Pool new_pool(pools.new_ranges.cbegin(), pools.new_ranges.cend());
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            auto diff = lazy_diff(old_pool, new_pool);
+            auto iter = std::ranges::find_if(diff, [](const Range& range) { return range.second > range.first; });
+            benchmark::DoNotOptimize(iter == diff.end());
+        }
+        allocations.report(state);
+        reportPerRange(state, pools);
+    }
+
+
+    // Diff nodes are cut out of an arena, which is released at once after every diff
+    template <Shape shape>
+    void BM_FindDiffPmrArena(benchmark::State& state)
+    {
+        const auto pools = makePools(shape, static_cast<std::size_t>(state.range(0)));
+        const Pool old_pool(pools.old_ranges.cbegin(), pools.old_ranges.cend());
+        const Pool new_pool(pools.new_ranges.cbegin(), pools.new_ranges.cend());
+
+        const AllocationsCounter allocations;
+        std::pmr::monotonic_buffer_resource arena;
+        for (auto _ : state)
+        {
+            {
+                auto diff = find_diff(old_pool, new_pool, &arena);
+                benchmark::DoNotOptimize(diff);
+            }
+            arena.release();
+        }
+        allocations.report(state);
+        reportPerRange(state, pools);
+    }
+
+
+    // Same pools in the upper half of IPv6 address space, to compare with `BM_FindDiffPool`
+    template <Shape shape>
+    void BM_FindDiffIPv6Pool(benchmark::State& state)
+    {
+        const auto pools = makePools(shape, static_cast<std::size_t>(state.range(0)));
+        const auto to_ipv6_pool = [](const std::vector<Range>& ranges)
+        {
+            const IPv6Address base = max_ipv6_address - IPv6Address{std::numeric_limits<IPAddress>::max()};
+            IPv6Pool pool;
+            for (const auto& range : ranges)
+            {
+                pool.emplace(base + range.first, base + range.second);
+            }
+            return pool;
+        };
+        const IPv6Pool old_pool = to_ipv6_pool(pools.old_ranges);
+        const IPv6Pool new_pool = to_ipv6_pool(pools.new_ranges);
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            auto diff = find_diff(old_pool, new_pool);
+            benchmark::DoNotOptimize(diff);
+        }
+        allocations.report(state);
+        reportPerRange(state, pools);
+    }
+
+
+    template <Shape shape>
+    void BM_FindDiffFlatPool(benchmark::State& state)
+    {
+        const auto pools = makePools(shape, static_cast<std::size_t>(state.range(0)));
+        const FlatPool old_pool(pools.old_ranges);
+        const FlatPool new_pool(pools.new_ranges);
+        std::vector<Range> diff;
+        diff.reserve(old_pool.size() + new_pool.size());
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            find_diff(old_pool, new_pool, diff);
+            benchmark::DoNotOptimize(diff.data());
+            benchmark::ClobberMemory();
+        }
+        allocations.report(state);
+        reportPerRange(state, pools);
+    }
+
+
+    template <Shape shape>
+    void BM_FindDiffNormalizedPool(benchmark::State& state)
+    {
+        const auto pools = makePools(shape, static_cast<std::size_t>(state.range(0)));
+        const NormalizedPool old_pool(FlatPool(pools.old_ranges));
+        const NormalizedPool new_pool(FlatPool(pools.new_ranges));
+        std::vector<Range> diff;
+        diff.reserve(old_pool.size() + new_pool.size());
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            diff.clear();
+            find_diff(old_pool, new_pool, std::back_inserter(diff));
+            benchmark::DoNotOptimize(diff.data());
+            benchmark::ClobberMemory();
+        }
+        allocations.report(state);
+        reportPerRange(state, pools);
+    }
+
+
+    template <Shape shape>
+    void BM_FindDiffStreaming(benchmark::State& state)
+    {
+        const auto pools = makePools(shape, static_cast<std::size_t>(state.range(0)));
+        const Pool old_pool(pools.old_ranges.cbegin(), pools.old_ranges.cend());
+        const Pool new_pool(pools.new_ranges.cbegin(), pools.new_ranges.cend());
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            std::size_t ranges_count = 0;
+            find_diff(old_pool, new_pool, [&ranges_count](const Range&) { ++ranges_count; });
+            benchmark::DoNotOptimize(ranges_count);
+        }
+        allocations.report(state);
+        reportPerRange(state, pools);
+    }
+
+
+    // Prefixes of diff straight from the diff pass, to compare with `BM_FindDiffThenCidrs`
+    template <Shape shape>
+    void BM_FindDiffCidrs(benchmark::State& state)
+    {
+        const auto pools = makePools(shape, static_cast<std::size_t>(state.range(0)));
+        const Pool old_pool(pools.old_ranges.cbegin(), pools.old_ranges.cend());
+        const Pool new_pool(pools.new_ranges.cbegin(), pools.new_ranges.cend());
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            std::size_t cidrs_count = 0;
+            find_diff(old_pool, new_pool, make_cidr_sink([&cidrs_count](const Cidr&) { ++cidrs_count; }));
+            benchmark::DoNotOptimize(cidrs_count);
+        }
+        allocations.report(state);
+        reportPerRange(state, pools);
+    }
+
+
+    // Diff is materialized into `Pool` first and then split into prefixes
+    template <Shape shape>
+    void BM_FindDiffThenCidrs(benchmark::State& state)
+    {
+        const auto pools = makePools(shape, static_cast<std::size_t>(state.range(0)));
+        const Pool old_pool(pools.old_ranges.cbegin(), pools.old_ranges.cend());
+        const Pool new_pool(pools.new_ranges.cbegin(), pools.new_ranges.cend());
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            auto cidrs = to_cidrs(find_diff(old_pool, new_pool));
+            benchmark::DoNotOptimize(cidrs);
+        }
+        allocations.report(state);
+        reportPerRange(state, pools);
+    }
+
+
+    // Both directions of diff in one pass, to compare with two calls of `find_diff`
+    // Diff of pools which are written to files and mapped, with the same streaming sink as above.
+    // Files stay in the page cache, so that's the cost of walking over mapped pages, not of reading the disk
+    template <Shape shape>
+    void BM_FindDiffMappedFile(benchmark::State& state)
+    {
+        const auto pools = makePools(shape, static_cast<std::size_t>(state.range(0)));
+        const auto directory = std::filesystem::temp_directory_path();
+        const auto old_path = directory / "netup_tt_benchmark_old.pool";
+        const auto new_path = directory / "netup_tt_benchmark_new.pool";
+        write_pool_file(old_path, FlatPool(pools.old_ranges));
+        write_pool_file(new_path, FlatPool(pools.new_ranges));
+
+        {
+            const MappedPoolFile old_pool(old_path);
+            const MappedPoolFile new_pool(new_path);
+            const AllocationsCounter allocations;
+            for (auto _ : state)
+            {
+                std::size_t ranges_count = 0;
+                find_diff(old_pool, new_pool, [&ranges_count](const Range&) { ++ranges_count; });
+                benchmark::DoNotOptimize(ranges_count);
+            }
+            allocations.report(state);
+            reportPerRange(state, pools);
+        }
+
+        std::filesystem::remove(old_path);
+        std::filesystem::remove(new_path);
+    }
+
+
+    template <Shape shape>
+    void BM_FindChanges(benchmark::State& state)
+    {
+        const auto pools = makePools(shape, static_cast<std::size_t>(state.range(0)));
+        const Pool old_pool(pools.old_ranges.cbegin(), pools.old_ranges.cend());
+        const Pool new_pool(pools.new_ranges.cbegin(), pools.new_ranges.cend());
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            auto changes = find_changes(old_pool, new_pool);
+            benchmark::DoNotOptimize(changes);
+        }
+        allocations.report(state);
+        reportPerRange(state, pools);
+    }
+
+
+    template <Shape shape>
+    void BM_FindDiffBothWays(benchmark::State& state)
+    {
+        const auto pools = makePools(shape, static_cast<std::size_t>(state.range(0)));
+        const Pool old_pool(pools.old_ranges.cbegin(), pools.old_ranges.cend());
+        const Pool new_pool(pools.new_ranges.cbegin(), pools.new_ranges.cend());
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            auto removed = find_diff(old_pool, new_pool);
+            auto added = find_diff(new_pool, old_pool);
+            benchmark::DoNotOptimize(removed);
+            benchmark::DoNotOptimize(added);
+        }
+        allocations.report(state);
+        reportPerRange(state, pools);
+    }
+
+
+    // One small range is inserted into the new pool and erased from it again,
+    // that's two updates of the diff (compare with `BM_FindDiffPool` which finds it from scratch)
+    template <Shape shape>
+    void BM_DiffTrackerUpdate(benchmark::State& state)
+    {
+        const auto pools = makePools(shape, static_cast<std::size_t>(state.range(0)));
+        PoolDiffTracker tracker(
+            Pool(pools.old_ranges.cbegin(), pools.old_ranges.cend()),
+            Pool(pools.new_ranges.cbegin(), pools.new_ranges.cend())
+        );
+
+        std::mt19937 gen(static_cast<std::mt19937::result_type>(state.range(0)));
+        std::uniform_int_distribution<IPAddress> start_distribution(0, std::numeric_limits<IPAddress>::max() - 256);
+        std::uniform_int_distribution<IPAddress> length_distribution(0, 255);
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            const IPAddress first = start_distribution(gen);
+            const Range range{first, first + length_distribution(gen)};
+            benchmark::DoNotOptimize(tracker.insert_new(range) && tracker.erase_new(range));
+        }
+        allocations.report(state);
+    }
+
+
+    template <Shape shape>
+    void BM_FindDiffParallel(benchmark::State& state)
+    {
+        const auto pools = makePools(shape, static_cast<std::size_t>(state.range(0)));
+        const FlatPool old_pool(pools.old_ranges);
+        const FlatPool new_pool(pools.new_ranges);
+        std::vector<Range> diff;
+        diff.reserve(old_pool.size() + new_pool.size());
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            find_diff_parallel(old_pool, new_pool, diff);
+            benchmark::DoNotOptimize(diff.data());
+            benchmark::ClobberMemory();
+        }
+        allocations.report(state);
+        reportPerRange(state, pools);
+    }
+
+
+    // One baseline of 1M ranges against `state.range(0)` tenant pools of 100 ranges each
+    struct TenantsData
+    {
+        Pool old_pool;
+        std::vector<Pool> new_pools;
+    };
+
+
+    TenantsData makeTenantsData(const std::size_t tenants_count)
+    {
+        std::mt19937 gen(1);
+        TenantsData data;
+        const auto old_ranges = makeOverlappingRanges(gen, 1'000'000);
+        data.old_pool = Pool(old_ranges.cbegin(), old_ranges.cend());
+        for (std::size_t tenant = 0; tenant < tenants_count; ++tenant)
+        {
+            const auto new_ranges = makeOverlappingRanges(gen, 100);
+            data.new_pools.emplace_back(new_ranges.cbegin(), new_ranges.cend());
+        }
+        return data;
+    }
+
+
+    void BM_FindDiffsLoop(benchmark::State& state)
+    {
+        const auto data = makeTenantsData(static_cast<std::size_t>(state.range(0)));
+
+        for (auto _ : state)
+        {
+            for (const auto& new_pool : data.new_pools)
+            {
+                auto diff = find_diff(data.old_pool, new_pool);
+                benchmark::DoNotOptimize(diff);
+            }
+        }
+    }
+
+
+    // Normalization of the baseline is included
+    void BM_FindDiffsBatch(benchmark::State& state)
+    {
+        const auto data = makeTenantsData(static_cast<std::size_t>(state.range(0)));
+
+        for (auto _ : state)
+        {
+            auto diffs = find_diffs(data.old_pool, data.new_pools);
+            benchmark::DoNotOptimize(diffs);
+        }
+    }
+
+
+    void tenantsCounts(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->RangeMultiplier(10)->Range(10, 1000)->Unit(benchmark::kMillisecond);
+    }
+
+
+    // `allocated \ (pool_1 ∪ ... ∪ pool_k)` for k = `state.range(0)` pools of 100K short ranges
+    // (like blacklists and tenants' pools) and 1M allocated ranges
+    struct SubtrahendsData
+    {
+        Pool old_pool;
+        std::vector<Pool> new_pools;
+        std::vector<const Pool*> new_pools_pointers;
+    };
+
+
+    Pool makeShortRangesPool(std::mt19937& gen, const std::size_t ranges_count, const IPAddress max_length)
+    {
+        std::uniform_int_distribution<IPAddress> start_distribution(0, std::numeric_limits<IPAddress>::max() - max_length);
+        std::uniform_int_distribution<IPAddress> length_distribution(1, max_length);
+        Pool pool;
+        for (std::size_t i = 0; i < ranges_count; ++i)
+        {
+            const IPAddress start = start_distribution(gen);
+            pool.emplace(start, start + length_distribution(gen) - 1);
+        }
+        return pool;
+    }
+
+
+    SubtrahendsData makeSubtrahendsData(const std::size_t pools_count)
+    {
+        std::mt19937 gen(1);
+        SubtrahendsData data;
+        data.old_pool = makeShortRangesPool(gen, 1'000'000, 4096);
+        data.new_pools.reserve(pools_count);
+        for (std::size_t index = 0; index < pools_count; ++index)
+        {
+            data.new_pools.push_back(makeShortRangesPool(gen, 100'000, 1024));
+            data.new_pools_pointers.push_back(&data.new_pools.back());
+        }
+        return data;
+    }
+
+
+    void BM_FindDiffChained(benchmark::State& state)
+    {
+        const auto data = makeSubtrahendsData(static_cast<std::size_t>(state.range(0)));
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            Pool diff = data.old_pool;
+            for (const auto& new_pool : data.new_pools)
+            {
+                diff = find_diff(diff, new_pool);
+            }
+            benchmark::DoNotOptimize(diff);
+        }
+        allocations.report(state);
+    }
+
+
+    void BM_FindDiffKWay(benchmark::State& state)
+    {
+        const auto data = makeSubtrahendsData(static_cast<std::size_t>(state.range(0)));
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            auto diff = find_diff(data.old_pool, data.new_pools_pointers);
+            benchmark::DoNotOptimize(diff);
+        }
+        allocations.report(state);
+    }
+
+
+    void subtrahendsCounts(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->Arg(2)->Arg(8)->Arg(32)->Unit(benchmark::kMillisecond);
+    }
+
+
+    // Reduced pool of 1M ranges and an update of `state.range(0)` pieces of its ranges
+    std::pair<Pool, Pool> makeUpdateData(const std::size_t update_size)
+    {
+        std::mt19937 gen(1);
+        const auto ranges = makeInterleavedRanges(1'000'000, 0);
+        std::pair<Pool, Pool> data{Pool(ranges.cbegin(), ranges.cend()), Pool{}};
+        std::uniform_int_distribution<std::size_t> index_distribution(0, ranges.size() - 1);
+        for (std::size_t i = 0; i < update_size; ++i)
+        {
+            const Range& range = ranges[index_distribution(gen)];
+            data.second.emplace(range.first + 1, range.first + (range.second - range.first) / 2);
+        }
+        return data;
+    }
+
+
+    // Update is subtracted and added back, so the pool is the same on every iteration
+    void BM_SubtractAddInPlace(benchmark::State& state)
+    {
+        auto [pool, update] = makeUpdateData(static_cast<std::size_t>(state.range(0)));
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            subtract_in_place(pool, update);
+            add_in_place(pool, update);
+            benchmark::DoNotOptimize(pool);
+        }
+        allocations.report(state);
+    }
+
+
+    // Subtraction only, by building a new pool
+    void BM_SubtractRebuild(benchmark::State& state)
+    {
+        const auto [pool, update] = makeUpdateData(static_cast<std::size_t>(state.range(0)));
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            auto result = find_diff(pool, update);
+            benchmark::DoNotOptimize(result);
+        }
+        allocations.report(state);
+    }
+
+
+    // Snapshots before and after the update: only changed ranges are visited
+    void BM_FindDiffSnapshots(benchmark::State& state)
+    {
+        const auto [pool, update] = makeUpdateData(static_cast<std::size_t>(state.range(0)));
+        const PersistentPool snapshot(pool);
+        PersistentPool current = snapshot;
+        for (const auto& range : update)
+        {
+            current.subtract(range);
+        }
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            auto diff = find_diff(snapshot, current);
+            benchmark::DoNotOptimize(diff);
+        }
+        allocations.report(state);
+    }
+
+
+    // Same with full copies of the pool as snapshots
+    void BM_FindDiffSnapshotsCopies(benchmark::State& state)
+    {
+        const auto [pool, update] = makeUpdateData(static_cast<std::size_t>(state.range(0)));
+        const Pool current = find_diff(pool, update);
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            auto diff = find_diff(pool, current);
+            benchmark::DoNotOptimize(diff);
+        }
+        allocations.report(state);
+    }
+
+
+    void updateSizes(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->RangeMultiplier(10)->Range(10, 100'000)->Unit(benchmark::kMicrosecond);
+    }
+
+
+    // Free space fragmented into `state.range(0)` ranges of 4 addresses, and one range of 64 addresses
+    // after all of them, so that first fit of a block of 16 addresses has to skip all short ranges
+    Pool makeFragmentedPool(const std::size_t ranges_count)
+    {
+        Pool pool;
+        for (std::size_t i = 0; i < ranges_count; ++i)
+        {
+            const auto first = static_cast<IPAddress>(8 * i);
+            pool.emplace_hint(pool.cend(), first, first + 3);
+        }
+        const auto first = static_cast<IPAddress>(8 * ranges_count);
+        pool.emplace_hint(pool.cend(), first, first + 63);
+        return pool;
+    }
+
+
+    // Block is allocated and released, so free space is the same on every iteration
+    void BM_AllocateBlock(benchmark::State& state)
+    {
+        AddressAllocator allocator(makeFragmentedPool(static_cast<std::size_t>(state.range(0))));
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            const auto block = allocator.allocate_block(16);
+            benchmark::DoNotOptimize(block);
+            allocator.release(*block);
+        }
+        allocations.report(state);
+    }
+
+
+    // Same with a plain pool of free ranges: the first long enough range is searched by a scan
+    void BM_AllocateBlockScan(benchmark::State& state)
+    {
+        Pool pool = makeFragmentedPool(static_cast<std::size_t>(state.range(0)));
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            const auto iter = std::find_if(pool.cbegin(), pool.cend(), [](const Range& range) { return range.second - range.first + 1 >= 16; });
+            const Pool block{{iter->first, iter->first + 15}};
+            subtract_in_place(pool, block);
+            benchmark::DoNotOptimize(pool);
+            add_in_place(pool, block);
+        }
+        allocations.report(state);
+    }
+
+
+    void freeRangesCounts(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->RangeMultiplier(10)->Range(1'000, 1'000'000)->Unit(benchmark::kMicrosecond);
+    }
+
+
+    // `state.range(0)` reader threads look up 1M addresses each in a pool of 1M ranges, while a writer
+    // thread removes 1000 pieces of its ranges and adds them back nonstop. Lookups and updates
+    // are counted per second, so that neither side is starved.
+    struct ContentionData
+    {
+        Pool pool;
+        Pool update;
+        std::vector<IPAddress> addresses;
+    };
+
+    ContentionData makeContentionData()
+    {
+        auto [pool, update] = makeUpdateData(1'000);
+        std::mt19937 gen(2);
+        std::uniform_int_distribution<IPAddress> address_distribution(0, std::prev(pool.cend())->second);
+        std::vector<IPAddress> addresses(1 << 16);
+        std::generate(addresses.begin(), addresses.end(), [&] { return address_distribution(gen); });
+        return {std::move(pool), std::move(update), std::move(addresses)};
+    }
+
+
+    template <typename Write, typename Lookup>
+    void runContention(benchmark::State& state, Write write, Lookup lookup)
+    {
+        constexpr std::size_t lookups_count = 1'000'000;
+        const auto readers_count = static_cast<std::size_t>(state.range(0));
+
+        std::atomic<std::uint64_t> updates_count{0};
+        std::jthread writer([&](const std::stop_token stop)
+        {
+            while (!stop.stop_requested())
+            {
+                write();
+                updates_count.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+        for (auto _ : state)
+        {
+            std::vector<std::jthread> readers;
+            for (std::size_t i = 0; i < readers_count; ++i)
+            {
+                readers.emplace_back([&lookup, i] { benchmark::DoNotOptimize(lookup(i, lookups_count)); });
+            }
+        }
+        writer.request_stop();
+        writer.join();
+
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * readers_count * lookups_count));
+        state.counters["updates"] = benchmark::Counter(static_cast<double>(updates_count), benchmark::Counter::kIsRate);
+    }
+
+
+    void BM_ContentionConcurrentPool(benchmark::State& state)
+    {
+        const auto data = makeContentionData();
+        ConcurrentPool pool{NormalizedPool(data.pool)};
+
+        bool is_removed = false;
+        runContention(
+            state,
+            [&]
+            {
+                is_removed ? pool.apply(Pool{}, data.update) : pool.apply(data.update, Pool{});
+                is_removed = !is_removed;
+            },
+            [&](const std::size_t reader_index, const std::size_t lookups_count)
+            {
+                const auto reader = pool.make_reader();
+                std::size_t found = 0;
+                for (std::size_t i = 0; i < lookups_count; ++i)
+                {
+                    found += reader.contains(data.addresses[(i + reader_index * 997) % data.addresses.size()]);
+                }
+                return found;
+            }
+        );
+    }
+
+
+    // The same with a global mutex and in-place updates of `std::set`
+    void BM_ContentionMutexPool(benchmark::State& state)
+    {
+        const auto data = makeContentionData();
+        Pool pool = data.pool;
+        std::mutex mutex;
+
+        bool is_removed = false;
+        runContention(
+            state,
+            [&]
+            {
+                const std::lock_guard lock(mutex);
+                is_removed ? add_in_place(pool, data.update) : subtract_in_place(pool, data.update);
+                is_removed = !is_removed;
+            },
+            [&](const std::size_t reader_index, const std::size_t lookups_count)
+            {
+                std::size_t found = 0;
+                for (std::size_t i = 0; i < lookups_count; ++i)
+                {
+                    const IPAddress address = data.addresses[(i + reader_index * 997) % data.addresses.size()];
+                    const std::lock_guard lock(mutex);
+                    const auto iter = pool.upper_bound(Range{address, std::numeric_limits<IPAddress>::max()});
+                    found += iter != pool.cbegin() && std::prev(iter)->second >= address;
+                }
+                return found;
+            }
+        );
+    }
+
+
+    void readersCounts(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->Arg(1)->Arg(4)->Arg(16)->Unit(benchmark::kMillisecond)->UseRealTime();
+    }
+
+
+    // Dense pools: `state.range(0)` chunks of 65536 addresses (256 is a whole /8 network)
+    // filled with short ranges and short holes between them
+    Pool makeDensePool(const std::size_t chunks_count, const std::mt19937::result_type seed)
+    {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<std::uint64_t> length_distribution(1, 16);
+        const std::uint64_t end = std::uint64_t{0x10000} * chunks_count;
+
+        Pool pool;
+        for (std::uint64_t first = length_distribution(gen); first < end; )
+        {
+            const std::uint64_t last = std::min(end - 1, first + length_distribution(gen) - 1);
+            pool.emplace_hint(pool.cend(), static_cast<IPAddress>(first), static_cast<IPAddress>(last));
+            first = last + 1 + length_distribution(gen);
+        }
+        return pool;
+    }
+
+
+    void BM_FindDiffDensePool(benchmark::State& state)
+    {
+        const Pool old_pool = makeDensePool(static_cast<std::size_t>(state.range(0)), 1);
+        const Pool new_pool = makeDensePool(static_cast<std::size_t>(state.range(0)), 2);
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            auto diff = find_diff(old_pool, new_pool);
+            benchmark::DoNotOptimize(diff);
+        }
+        allocations.report(state);
+    }
+
+
+    void BM_FindDiffDenseRoaringPool(benchmark::State& state)
+    {
+        const RoaringPool old_pool(makeDensePool(static_cast<std::size_t>(state.range(0)), 1));
+        const RoaringPool new_pool(makeDensePool(static_cast<std::size_t>(state.range(0)), 2));
+        state.counters["pool_bytes"] = static_cast<double>(old_pool.bytes_used());
+
+        const AllocationsCounter allocations;
+        for (auto _ : state)
+        {
+            auto diff = find_diff(old_pool, new_pool);
+            benchmark::DoNotOptimize(diff);
+        }
+        allocations.report(state);
+    }
+
+
+    void denseChunksCounts(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->RangeMultiplier(16)->Range(1, 256)->Unit(benchmark::kMicrosecond);
+    }
+
+
+    std::string formatAddress(const IPAddress address)
+    {
+        return std::to_string(address >> 24) + '.' + std::to_string((address >> 16) & 0xFF) + '.'
+            + std::to_string((address >> 8) & 0xFF) + '.' + std::to_string(address & 0xFF);
+    }
+
+
+    // Text pool of `ranges_count` lines, half of them are ranges, the rest are prefixes and single addresses.
+    // Lines are sorted (like exported lists usually are), so the time goes to parsing rather than sorting
+    std::string makePoolText(const std::size_t ranges_count)
+    {
+        std::mt19937 gen(ranges_count);
+        std::vector<IPAddress> firsts(ranges_count);
+        std::generate(firsts.begin(), firsts.end(), [&gen]() { return gen() & ~IPAddress{0xFF}; });
+        std::sort(firsts.begin(), firsts.end());
+
+        std::string text;
+        for (std::size_t i = 0; i < ranges_count; ++i)
+        {
+            const IPAddress first = firsts[i];
+            switch (i % 4)
+            {
+            case 0:
+            {
+                const IPAddress prefix_length = 24 - gen() % 8;
+                text += formatAddress(first & ~(std::numeric_limits<IPAddress>::max() >> prefix_length)) + '/' + std::to_string(prefix_length) + '\n';
+                break;
+            }
+            case 1:
+                text += formatAddress(first + gen() % 256) + '\n';
+                break;
+            default:
+                text += formatAddress(first) + '-' + formatAddress(first + gen() % 256) + '\n';
+                break;
+            }
+        }
+        return text;
+    }
+
+
+    template <AddressParser parser>
+    void BM_ParsePoolText(benchmark::State& state)
+    {
+        const std::string text = makePoolText(static_cast<std::size_t>(state.range(0)));
+
+        for (auto _ : state)
+        {
+            auto pool = parse_pool_text(text, parser);
+            benchmark::DoNotOptimize(pool);
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * text.size()));
+    }
+
+
+    // Membership lookups of random addresses in a reduced pool of `state.range(0)` ranges
+    constexpr std::size_t lookups_count = 4096;
+
+
+    struct LookupData
+    {
+        NormalizedPool pool;
+        std::vector<IPAddress> addresses;
+    };
+
+
+    LookupData makeLookupData(const std::size_t ranges_count)
+    {
+        std::mt19937 gen(ranges_count);
+        LookupData data{NormalizedPool(FlatPool(makeInterleavedRanges(ranges_count, 0))), {}};
+        std::uniform_int_distribution<IPAddress> address_distribution;
+        data.addresses.resize(lookups_count);
+        for (auto& address : data.addresses)
+        {
+            address = address_distribution(gen);
+        }
+        return data;
+    }
+
+
+    void BM_ContainsPool(benchmark::State& state)
+    {
+        const auto data = makeLookupData(static_cast<std::size_t>(state.range(0)));
+        const Pool pool = data.pool.to_pool();
+
+        for (auto _ : state)
+        {
+            std::size_t found = 0;
+            for (const auto address : data.addresses)
+            {
+                // The last range which starts at `address` or before it
+                auto iter = pool.upper_bound(Range{address, std::numeric_limits<IPAddress>::max()});
+                found += iter != pool.cbegin() && std::prev(iter)->second >= address;
+            }
+            benchmark::DoNotOptimize(found);
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * lookups_count));
+    }
+
+
+    void BM_ContainsIndex(benchmark::State& state)
+    {
+        const auto data = makeLookupData(static_cast<std::size_t>(state.range(0)));
+        const PoolIndex index(data.pool);
+
+        for (auto _ : state)
+        {
+            std::size_t found = 0;
+            for (const auto address : data.addresses)
+            {
+                found += index.contains(address);
+            }
+            benchmark::DoNotOptimize(found);
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * lookups_count));
+    }
+
+
+    void BM_ContainsIndexBatch(benchmark::State& state)
+    {
+        const auto data = makeLookupData(static_cast<std::size_t>(state.range(0)));
+        const PoolIndex index(data.pool);
+        std::vector<std::uint64_t> bitmask(lookups_count / 64);
+
+        for (auto _ : state)
+        {
+            index.contains(data.addresses, bitmask);
+            benchmark::DoNotOptimize(bitmask.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * lookups_count));
+    }
+
+
+    template <PoolClassifier::Kernel kernel>
+    void BM_Classify(benchmark::State& state)
+    {
+        const auto data = makeLookupData(static_cast<std::size_t>(state.range(0)));
+        const PoolClassifier classifier(data.pool);
+        std::vector<std::uint32_t> range_indexes(lookups_count);
+
+        for (auto _ : state)
+        {
+            classifier.classify(data.addresses, range_indexes, kernel);
+            benchmark::DoNotOptimize(range_indexes.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * lookups_count));
+    }
+
+
+    void classifierPoolSizes(benchmark::internal::Benchmark* benchmark)
+    {
+        // The classifier is meant for small and medium pools
+        benchmark->RangeMultiplier(4)->Range(4, 16'384)->Unit(benchmark::kMicrosecond);
+    }
+
+
+    void poolSizes(benchmark::internal::Benchmark* benchmark)
+    {
+        benchmark->RangeMultiplier(10)->Range(1, 10'000'000)->Unit(benchmark::kMicrosecond);
+    }
+
+
+    BENCHMARK_TEMPLATE(BM_FindDiffPool, Shape::heavy_overlap)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffPool, Shape::nested)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffPool, Shape::disjoint_interleaving)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffPool, Shape::lopsided)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffPool, Shape::lopsided_reduced)->Apply(poolSizes);
+
+    BENCHMARK_TEMPLATE(BM_FindDiffThenCount, Shape::heavy_overlap)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffThenCount, Shape::disjoint_interleaving)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_DiffStats, Shape::heavy_overlap)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_DiffStats, Shape::disjoint_interleaving)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_DiffStatsHistogram, Shape::disjoint_interleaving)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffFirstFit, Shape::heavy_overlap)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_LazyDiffFirstFit, Shape::heavy_overlap)->Apply(poolSizes);
+
+    BENCHMARK_TEMPLATE(BM_FindDiffPmrArena, Shape::heavy_overlap)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffPmrArena, Shape::nested)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffPmrArena, Shape::disjoint_interleaving)->Apply(poolSizes);
+
+    BENCHMARK_TEMPLATE(BM_FindDiffIPv6Pool, Shape::heavy_overlap)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffIPv6Pool, Shape::nested)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffIPv6Pool, Shape::disjoint_interleaving)->Apply(poolSizes);
+
+    BENCHMARK_TEMPLATE(BM_FindDiffFlatPool, Shape::heavy_overlap)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffFlatPool, Shape::nested)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffFlatPool, Shape::disjoint_interleaving)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffFlatPool, Shape::lopsided)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffFlatPool, Shape::lopsided_reduced)->Apply(poolSizes);
+
+    BENCHMARK_TEMPLATE(BM_FindDiffNormalizedPool, Shape::heavy_overlap)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffNormalizedPool, Shape::nested)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffNormalizedPool, Shape::disjoint_interleaving)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffNormalizedPool, Shape::lopsided)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffNormalizedPool, Shape::lopsided_reduced)->Apply(poolSizes);
+
+    BENCHMARK_TEMPLATE(BM_FindDiffStreaming, Shape::heavy_overlap)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffStreaming, Shape::nested)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffStreaming, Shape::disjoint_interleaving)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffStreaming, Shape::lopsided)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffStreaming, Shape::lopsided_reduced)->Apply(poolSizes);
+
+    BENCHMARK_TEMPLATE(BM_FindDiffCidrs, Shape::heavy_overlap)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffCidrs, Shape::nested)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffCidrs, Shape::disjoint_interleaving)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffThenCidrs, Shape::heavy_overlap)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffThenCidrs, Shape::nested)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffThenCidrs, Shape::disjoint_interleaving)->Apply(poolSizes);
+
+    BENCHMARK_TEMPLATE(BM_FindDiffMappedFile, Shape::heavy_overlap)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffMappedFile, Shape::nested)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffMappedFile, Shape::disjoint_interleaving)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffMappedFile, Shape::lopsided)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffMappedFile, Shape::lopsided_reduced)->Apply(poolSizes);
+
+    BENCHMARK_TEMPLATE(BM_FindChanges, Shape::heavy_overlap)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindChanges, Shape::nested)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindChanges, Shape::disjoint_interleaving)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffBothWays, Shape::heavy_overlap)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffBothWays, Shape::nested)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_FindDiffBothWays, Shape::disjoint_interleaving)->Apply(poolSizes);
+
+    BENCHMARK_TEMPLATE(BM_DiffTrackerUpdate, Shape::heavy_overlap)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_DiffTrackerUpdate, Shape::nested)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_DiffTrackerUpdate, Shape::disjoint_interleaving)->Apply(poolSizes);
+
+    BENCHMARK_TEMPLATE(BM_FindDiffParallel, Shape::heavy_overlap)->Apply(poolSizes)->UseRealTime();
+    BENCHMARK_TEMPLATE(BM_FindDiffParallel, Shape::nested)->Apply(poolSizes)->UseRealTime();
+    BENCHMARK_TEMPLATE(BM_FindDiffParallel, Shape::disjoint_interleaving)->Apply(poolSizes)->UseRealTime();
+    BENCHMARK_TEMPLATE(BM_FindDiffParallel, Shape::lopsided)->Apply(poolSizes)->UseRealTime();
+    BENCHMARK_TEMPLATE(BM_FindDiffParallel, Shape::lopsided_reduced)->Apply(poolSizes)->UseRealTime();
+
+    // A loop over 1000 tenants takes minutes
+    BENCHMARK(BM_FindDiffsLoop)->Arg(10)->Arg(100)->Unit(benchmark::kMillisecond);
+    BENCHMARK(BM_FindDiffsBatch)->Apply(tenantsCounts)->UseRealTime();
+
+    BENCHMARK(BM_FindDiffChained)->Apply(subtrahendsCounts);
+    BENCHMARK(BM_FindDiffKWay)->Apply(subtrahendsCounts);
+
+    BENCHMARK(BM_SubtractAddInPlace)->Apply(updateSizes);
+    BENCHMARK(BM_SubtractRebuild)->Apply(updateSizes);
+    BENCHMARK(BM_FindDiffSnapshots)->Apply(updateSizes);
+    BENCHMARK(BM_FindDiffSnapshotsCopies)->Apply(updateSizes);
+
+    BENCHMARK(BM_AllocateBlock)->Apply(freeRangesCounts);
+    BENCHMARK(BM_AllocateBlockScan)->Apply(freeRangesCounts);
+
+    BENCHMARK(BM_ContentionConcurrentPool)->Apply(readersCounts);
+    BENCHMARK(BM_ContentionMutexPool)->Apply(readersCounts);
+
+    BENCHMARK(BM_FindDiffDensePool)->Apply(denseChunksCounts);
+    BENCHMARK(BM_FindDiffDenseRoaringPool)->Apply(denseChunksCounts);
+
+    BENCHMARK_TEMPLATE(BM_ParsePoolText, AddressParser::scalar)->Apply(poolSizes);
+    BENCHMARK_TEMPLATE(BM_ParsePoolText, AddressParser::ssse3)->Apply(poolSizes);
+
+    BENCHMARK(BM_ContainsPool)->Apply(poolSizes);
+    BENCHMARK(BM_ContainsIndex)->Apply(poolSizes);
+    BENCHMARK(BM_ContainsIndexBatch)->Apply(poolSizes);
+
+    BENCHMARK(BM_ContainsIndexBatch)->Apply(classifierPoolSizes);
+    BENCHMARK_TEMPLATE(BM_Classify, PoolClassifier::Kernel::scalar)->Apply(classifierPoolSizes);
+    BENCHMARK_TEMPLATE(BM_Classify, PoolClassifier::Kernel::avx2)->Apply(classifierPoolSizes);
+
+} // anonymous namespace
+
+
+int main(int argc, char** argv)
+try
+{
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return EXIT_SUCCESS;
+}
+catch (const std::exception& ex)
+{
+    std::cerr << "Exception has been thrown: " << ex.what() << '\n';
+    return EXIT_FAILURE;
+}
+catch (...)
+{
+    std::cerr << "Unknown exception has been thrown\n";
+    return EXIT_FAILURE;
+}
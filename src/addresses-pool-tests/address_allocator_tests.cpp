@@ -0,0 +1,165 @@
+#include <cstddef>
+#include <cstdint>
+
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "address_allocator.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+    constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+
+
+    TEST(TestAddressAllocator, TestAllocate)
+    {
+        AddressAllocator allocator(Pool{{10, 12}, {13, 14}, {20, 20}});
+        ASSERT_EQ((Pool{{10, 14}, {20, 20}}), allocator.free_pool());
+        ASSERT_EQ(6u, allocator.free_addresses_count());
+
+        for (IPAddress address : {10, 11, 12, 13, 14, 20})
+        {
+            ASSERT_EQ(address, allocator.allocate());
+        }
+        ASSERT_EQ(std::nullopt, allocator.allocate());
+        ASSERT_EQ(0u, allocator.free_addresses_count());
+        ASSERT_EQ(0u, allocator.free_ranges_count());
+
+        ASSERT_EQ(std::nullopt, AddressAllocator().allocate());
+    }
+
+
+    TEST(TestAddressAllocator, TestFits)
+    {
+        AddressAllocator allocator(Pool{{0, 9}, {20, 22}, {30, 33}, {40, 41}});
+
+        // The first range long enough vs the shortest one
+        ASSERT_EQ((Range{0, 2}), allocator.allocate_block(3, AddressAllocator::Fit::first));
+        ASSERT_EQ((Range{20, 22}), allocator.allocate_block(3, AddressAllocator::Fit::best));
+        ASSERT_EQ(40u, allocator.allocate(AddressAllocator::Fit::best));
+        ASSERT_EQ((Range{30, 33}), allocator.allocate_block(4, AddressAllocator::Fit::best));
+        ASSERT_EQ(std::nullopt, allocator.allocate_block(8));
+        ASSERT_EQ((Range{3, 9}), allocator.allocate_block(7));
+        ASSERT_EQ((Pool{{41, 41}}), allocator.free_pool());
+
+        ASSERT_THROW(allocator.allocate_block(0), std::invalid_argument);
+
+        AddressAllocator whole(Pool{{0, upper_limit}});
+        ASSERT_EQ(std::uint64_t{1} << 32, whole.free_addresses_count());
+        ASSERT_EQ((Range{0, upper_limit}), whole.allocate_block(std::uint64_t{1} << 32));
+        ASSERT_EQ(std::nullopt, whole.allocate());
+    }
+
+
+    TEST(TestAddressAllocator, TestPrefixes)
+    {
+        // [1, 6] has 6 addresses, but no aligned block of 4 of them
+        AddressAllocator allocator(Pool{{1, 6}, {9, 17}, {100, 131}});
+
+        ASSERT_EQ((Cidr{12, 30}), allocator.allocate_prefix(30, AddressAllocator::Fit::first));
+        ASSERT_EQ((Cidr{16, 31}), allocator.allocate_prefix(31, AddressAllocator::Fit::best));
+        ASSERT_EQ((Cidr{104, 29}), allocator.allocate_prefix(29));
+        ASSERT_EQ((Cidr{112, 28}), allocator.allocate_prefix(28, AddressAllocator::Fit::best));
+        ASSERT_EQ(std::nullopt, allocator.allocate_prefix(27));
+        ASSERT_EQ((Pool{{1, 6}, {9, 11}, {100, 103}, {128, 131}}), allocator.free_pool());
+
+        ASSERT_THROW(allocator.allocate_prefix(33), std::invalid_argument);
+
+        AddressAllocator whole(Pool{{0, upper_limit}});
+        ASSERT_EQ((Cidr{0, 0}), whole.allocate_prefix(0));
+    }
+
+
+    TEST(TestAddressAllocator, TestReleaseAndReserve)
+    {
+        AddressAllocator allocator(Pool{{0, 100}, {upper_limit - 10, upper_limit}}, Pool{{10, 20}, {50, 60}, {upper_limit, upper_limit}});
+        ASSERT_EQ((Pool{{0, 9}, {21, 49}, {61, 100}, {upper_limit - 10, upper_limit - 1}}), allocator.free_pool());
+
+        // Released addresses are glued with free ones around them
+        allocator.release(Range{10, 15});
+        allocator.release(Range{upper_limit, upper_limit});
+        ASSERT_EQ((Pool{{0, 15}, {21, 49}, {61, 100}, {upper_limit - 10, upper_limit}}), allocator.free_pool());
+        allocator.release(Range{16, 20});
+        ASSERT_EQ((Pool{{0, 49}, {61, 100}, {upper_limit - 10, upper_limit}}), allocator.free_pool());
+
+        ASSERT_THROW(allocator.release(Range{55, 61}), std::invalid_argument);
+        ASSERT_THROW(allocator.release(Range{20, 10}), std::invalid_argument);
+        ASSERT_EQ((Pool{{0, 49}, {61, 100}, {upper_limit - 10, upper_limit}}), allocator.free_pool());
+
+        ASSERT_TRUE(allocator.reserve(Range{5, 7}));
+        ASSERT_TRUE(allocator.reserve(Range{upper_limit, upper_limit}));
+        ASSERT_FALSE(allocator.reserve(Range{45, 65}));
+        ASSERT_FALSE(allocator.reserve(Range{6, 6}));
+        ASSERT_EQ((Pool{{0, 4}, {8, 49}, {61, 100}, {upper_limit - 10, upper_limit - 1}}), allocator.free_pool());
+
+        ASSERT_TRUE(allocator.is_free(8));
+        ASSERT_FALSE(allocator.is_free(7));
+        ASSERT_FALSE(allocator.is_free(upper_limit));
+        ASSERT_EQ(0u, allocator.allocate());
+    }
+
+
+    TEST(TestAddressAllocator, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348};
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            const Pool capacity = makeRandomPool(gen, 1'000'000, 1'000, 2'000);
+            AddressAllocator allocator(capacity);
+            Pool free_addresses = find_diff(capacity, Pool{});
+            std::vector<Range> allocated;
+
+            std::uniform_int_distribution<std::uint64_t> size_distribution(1, 2'000);
+            for (std::size_t step = 0; step < 3'000; ++step)
+            {
+                const auto fit = step % 3 == 0 ? AddressAllocator::Fit::best : AddressAllocator::Fit::first;
+                if (step % 4 == 3 && !allocated.empty())
+                {
+                    std::uniform_int_distribution<std::size_t> index_distribution(0, allocated.size() - 1);
+                    const auto index = index_distribution(gen);
+                    allocator.release(allocated[index]);
+                    free_addresses.insert(allocated[index]);
+                    free_addresses = find_diff(free_addresses, Pool{});
+                    allocated.erase(allocated.begin() + static_cast<std::ptrdiff_t>(index));
+                }
+                else
+                {
+                    const auto size = size_distribution(gen);
+                    const auto block = step % 5 == 0
+                        ? [&] { const auto cidr = allocator.allocate_prefix(static_cast<std::uint8_t>(32 - size % 10), fit); return cidr ? std::optional(cidr->to_range()) : std::nullopt; }()
+                        : allocator.allocate_block(size, fit);
+                    if (block)
+                    {
+                        ASSERT_TRUE(find_diff(Pool{*block}, free_addresses).empty());
+                        if (fit == AddressAllocator::Fit::first && step % 5 != 0)
+                        {
+                            // Nothing fits before it
+                            for (const auto& range : free_addresses)
+                            {
+                                if (range.first >= block->first)
+                                {
+                                    break;
+                                }
+                                ASSERT_LT(std::uint64_t{range.second} - range.first + 1, size);
+                            }
+                        }
+                        free_addresses = find_diff(free_addresses, Pool{*block});
+                        allocated.push_back(*block);
+                    }
+                }
+                ASSERT_EQ(free_addresses, allocator.free_pool());
+            }
+        }
+    }
+
+} // anonymous namespace
@@ -0,0 +1,127 @@
+#include <cstddef>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "batch_diff.h"
+#include "test_helpers.h"
+#include "work_stealing_executor.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+
+    TEST(TestWorkStealingExecutor, TestAllTasksRunOnce)
+    {
+        for (const std::size_t threads_count : {1, 2, 3, 8})
+        {
+            for (const std::size_t tasks_count : {0, 1, 2, 7, 1000})
+            {
+                std::vector<std::atomic<int>> runs(tasks_count);
+                const auto execute = make_work_stealing_executor(threads_count);
+                execute(tasks_count, [&runs](const std::size_t index)
+                {
+                    // Tasks at the beginning are slow, so the others are stolen from the first thread
+                    if (index < 3)
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                    }
+                    ++runs[index];
+                });
+                for (const auto& count : runs)
+                {
+                    ASSERT_EQ(1, count.load());
+                }
+            }
+        }
+    }
+
+
+    TEST(TestWorkStealingExecutor, TestExceptions)
+    {
+        std::atomic<std::size_t> finished = 0;
+        const auto execute = make_work_stealing_executor(4);
+        ASSERT_THROW(
+            execute(100, [&finished](const std::size_t index)
+            {
+                if (index % 10 == 3)
+                {
+                    throw std::runtime_error("Task failed");
+                }
+                ++finished;
+            }),
+            std::runtime_error
+        );
+        // Failures don't stop other tasks
+        ASSERT_EQ(90, finished.load());
+    }
+
+
+    TEST(TestBatchDiff, TestSmallPools)
+    {
+        const Pool old_pool{{1, 37}, {37, 89}, {80, 100}, {200, 300}};
+        const std::vector<Pool> new_pools{
+            {}, {{10, 20}, {30, 40}}, {{0, 1000}}, {{50, 80}, {150, 180}, {190, 202}, {220, 235}}
+        };
+
+        std::size_t executor_calls = 0;
+        BatchDiffOptions options;
+        options.executor = [&executor_calls](const std::size_t tasks_count, const std::function<void(std::size_t)>& task)
+        {
+            ++executor_calls;
+            for (std::size_t index = 0; index < tasks_count; ++index)
+            {
+                task(index);
+            }
+        };
+
+        const auto diffs = find_diffs(old_pool, new_pools, options);
+        ASSERT_EQ(1, executor_calls);
+        ASSERT_EQ(new_pools.size(), diffs.size());
+        for (std::size_t index = 0; index < new_pools.size(); ++index)
+        {
+            ASSERT_EQ(find_diff(old_pool, new_pools[index]), diffs[index].to_pool());
+        }
+        ASSERT_TRUE(find_diffs(old_pool, std::vector<Pool>{}).empty());
+    }
+
+
+    TEST(TestBatchDiff, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348};
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            const Pool old_pool = makeRandomPool(gen, 10'000'000, 10'000, 20'000);
+            std::vector<Pool> new_pools;
+            std::vector<FlatPool> new_flat_pools;
+            for (std::size_t tenant = 0; tenant < 50; ++tenant)
+            {
+                // Tenants of very different sizes
+                new_pools.push_back(makeRandomPool(gen, 10'000'000, 50'000, tenant * tenant));
+                new_flat_pools.emplace_back(new_pools.back());
+            }
+
+            BatchDiffOptions options;
+            options.executor = make_work_stealing_executor(4);
+            const auto diffs = find_diffs(old_pool, new_pools, options);
+            const auto flat_diffs = find_diffs(NormalizedPool(old_pool), new_flat_pools, options);
+            ASSERT_EQ(diffs, flat_diffs);
+            for (std::size_t index = 0; index < new_pools.size(); ++index)
+            {
+                ASSERT_EQ(find_diff(old_pool, new_pools[index]), diffs[index].to_pool());
+            }
+        }
+    }
+
+} // anonymous namespace
@@ -0,0 +1,128 @@
+#include <cstdint>
+
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cidr.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+    constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+
+
+    std::vector<Cidr> splitRange(const Range& range)
+    {
+        std::vector<Cidr> cidrs;
+        for_each_cidr(range, [&cidrs](const Cidr& cidr) { cidrs.push_back(cidr); });
+        return cidrs;
+    }
+
+
+    // Straightforward greedy decomposition: the shortest prefix which starts at the current address
+    // and fits into the range is taken, trying all lengths one by one
+    std::vector<Cidr> naiveSplitRanges(const Pool& pool)
+    {
+        std::vector<Cidr> cidrs;
+        for (const auto& range : find_diff(pool, Pool{}))
+        {
+            std::uint64_t first = range.first;
+            while (first <= range.second)
+            {
+                for (int prefix_length = 0; prefix_length <= 32; ++prefix_length)
+                {
+                    const std::uint64_t size = std::uint64_t{1} << (32 - prefix_length);
+                    if (first % size == 0 && first + size - 1 <= range.second)
+                    {
+                        cidrs.push_back({static_cast<IPAddress>(first), static_cast<std::uint8_t>(prefix_length)});
+                        first += size;
+                        break;
+                    }
+                }
+            }
+        }
+        return cidrs;
+    }
+
+
+    TEST(TestCidr, TestSplitRange)
+    {
+        ASSERT_EQ((std::vector<Cidr>{{5, 32}, {6, 31}, {8, 29}, {16, 30}, {20, 32}}), splitRange({5, 20}));
+        ASSERT_EQ((std::vector<Cidr>{{7, 32}}), splitRange({7, 7}));
+        ASSERT_EQ((std::vector<Cidr>{{0x0A000000, 8}}), splitRange({0x0A000000, 0x0AFFFFFF}));
+
+        // Edges of the address space
+        ASSERT_EQ((std::vector<Cidr>{{0, 0}}), splitRange({0, upper_limit}));
+        ASSERT_EQ((std::vector<Cidr>{{0, 32}}), splitRange({0, 0}));
+        ASSERT_EQ((std::vector<Cidr>{{upper_limit, 32}}), splitRange({upper_limit, upper_limit}));
+        ASSERT_EQ((std::vector<Cidr>{{1, 32}, {2, 31}, {4, 30}}), splitRange({1, 7}));
+        ASSERT_EQ((std::vector<Cidr>{{0x80000000, 1}}), splitRange({0x80000000, upper_limit}));
+        ASSERT_EQ(62, splitRange({1, upper_limit - 1}).size());
+
+        ASSERT_EQ((Range{0, upper_limit}), (Cidr{0, 0}.to_range()));
+        ASSERT_EQ((Range{upper_limit, upper_limit}), (Cidr{upper_limit, 32}.to_range()));
+    }
+
+
+    TEST(TestCidr, TestConversions)
+    {
+        ASSERT_TRUE(to_cidrs(Pool{}).empty());
+        ASSERT_TRUE(from_cidrs({}).empty());
+
+        // Intersecting and adjacent ranges are reduced first
+        const Pool pool{{0, 3}, {2, 7}, {8, 8}, {10, 11}, {12, 15}};
+        const std::vector<Cidr> cidrs{{0, 29}, {8, 32}, {10, 31}, {12, 30}};
+        ASSERT_EQ(cidrs, to_cidrs(pool));
+        ASSERT_EQ(find_diff(pool, Pool{}), from_cidrs(cidrs));
+
+        // Prefixes in any order, nested ones included
+        const std::vector<Cidr> unordered{{12, 30}, {0, 29}, {4, 30}, {10, 31}, {8, 32}};
+        ASSERT_EQ((Pool{{0, 8}, {10, 15}}), from_cidrs(unordered));
+
+        ASSERT_THROW(from_cidrs(std::vector<Cidr>{{0, 33}}), std::invalid_argument);
+        ASSERT_THROW(from_cidrs(std::vector<Cidr>{{1, 31}}), std::invalid_argument);
+        ASSERT_THROW(from_cidrs(std::vector<Cidr>{{0x0A000100, 16}}), std::invalid_argument);
+    }
+
+
+    TEST(TestCidr, TestFusedDiff)
+    {
+        const Pool old_addresses{{1, 37}, {37, 89}, {80, 100}, {200, 300}};
+        const Pool new_addresses{{10, 20}, {30, 40}, {50, 80}, {150, 180}, {190, 202}, {220, 235}};
+
+        std::vector<Cidr> cidrs;
+        find_diff(old_addresses, new_addresses, make_cidr_sink([&cidrs](const Cidr& cidr) { cidrs.push_back(cidr); }));
+        ASSERT_EQ(to_cidrs(find_diff(old_addresses, new_addresses)), cidrs);
+    }
+
+
+    TEST(TestCidr, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348};
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            const Pool old_pool = makeRandomPool(gen, 1'000'000, 5'000, 1'000);
+            const Pool new_pool = makeRandomPool(gen, 1'000'000, 5'000, 1'000);
+
+            const std::vector<Cidr> cidrs = to_cidrs(old_pool);
+            ASSERT_EQ(naiveSplitRanges(old_pool), cidrs);
+            ASSERT_EQ(find_diff(old_pool, Pool{}), from_cidrs(cidrs));
+
+            const Pool diff = find_diff(old_pool, new_pool);
+            std::vector<Cidr> diff_cidrs;
+            find_diff(old_pool, new_pool, make_cidr_sink([&diff_cidrs](const Cidr& cidr) { diff_cidrs.push_back(cidr); }));
+            ASSERT_EQ(naiveSplitRanges(diff), diff_cidrs);
+            ASSERT_EQ(diff, from_cidrs(diff_cidrs));
+        }
+    }
+
+} // anonymous namespace
@@ -0,0 +1,126 @@
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "concurrent_pool.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+
+
+    TEST(TestConcurrentPool, TestVersions)
+    {
+        ConcurrentPool pool(NormalizedPool(Pool{{0, 10}, {20, 30}}));
+        const auto reader = pool.make_reader();
+        ASSERT_EQ(0u, pool.version());
+        ASSERT_TRUE(reader.contains(5));
+        ASSERT_FALSE(reader.contains(15));
+
+        pool.apply(Pool{{5, 5}, {25, 40}}, Pool{{11, 19}, {100, 100}});
+        ASSERT_EQ(1u, pool.version());
+        reader.read([](const ConcurrentPool::Snapshot& snapshot)
+        {
+            ASSERT_EQ(1u, snapshot.number);
+            ASSERT_EQ((Pool{{0, 4}, {6, 24}, {100, 100}}), snapshot.pool.to_pool());
+        });
+
+        const std::vector<IPAddress> addresses{0, 5, 15, 25, 100};
+        std::vector<std::uint64_t> bitmask(1);
+        reader.contains(addresses, bitmask);
+        ASSERT_EQ(0b10101u, bitmask[0]);
+
+        pool.assign(NormalizedPool());
+        ASSERT_EQ(2u, pool.version());
+        ASSERT_FALSE(reader.contains(0));
+        // Nobody has been reading, so replaced versions are freed right away
+        ASSERT_EQ(0u, pool.retired_count());
+    }
+
+
+    TEST(TestConcurrentPool, TestReclamationWaitsForReaders)
+    {
+        ConcurrentPool pool(NormalizedPool(Pool{{0, 10}}));
+        const auto reader = pool.make_reader();
+        const auto other_reader = pool.make_reader();
+
+        reader.read([&pool, &other_reader](const ConcurrentPool::Snapshot& snapshot)
+        {
+            pool.apply(Pool{{0, 10}}, Pool{{20, 30}});
+            pool.apply(Pool{}, Pool{{40, 50}});
+            // The reader is still in the first version, so neither of replaced versions may be freed
+            ASSERT_EQ(2u, pool.retired_count());
+            ASSERT_EQ((Pool{{0, 10}}), snapshot.pool.to_pool());
+            ASSERT_TRUE(snapshot.index.contains(10));
+            // New reads see the new version
+            ASSERT_FALSE(other_reader.contains(10));
+            ASSERT_TRUE(other_reader.contains(45));
+        });
+
+        pool.apply(Pool{}, Pool{});
+        ASSERT_EQ(0u, pool.retired_count());
+        ASSERT_EQ(3u, pool.version());
+    }
+
+
+    TEST(TestConcurrentPool, TestConcurrentReadersAndWriter)
+    {
+        // Even versions have [0, 99], odd versions have [100, 199]
+        const Pool even_pool{{0, 99}};
+        const Pool odd_pool{{100, 199}};
+        ConcurrentPool pool(NormalizedPool{even_pool});
+
+        constexpr std::uint64_t versions_count = 300;
+        std::atomic<bool> is_failed{false};
+        {
+            std::vector<std::jthread> readers;
+            for (std::size_t i = 0; i < 4; ++i)
+            {
+                readers.emplace_back([&pool, &is_failed]
+                {
+                    const auto reader = pool.make_reader();
+                    std::uint64_t last_number = 0;
+                    while (last_number < versions_count)
+                    {
+                        reader.read([&](const ConcurrentPool::Snapshot& snapshot)
+                        {
+                            const bool is_even = snapshot.number % 2 == 0;
+                            if (snapshot.number < last_number
+                                || snapshot.index.contains(50) != is_even
+                                || snapshot.index.contains(150) == is_even
+                                || snapshot.pool.size() != 1)
+                            {
+                                is_failed = true;
+                            }
+                            last_number = snapshot.number;
+                        });
+                    }
+                });
+            }
+
+            for (std::uint64_t number = 1; number <= versions_count; ++number)
+            {
+                if (number % 2 == 0)
+                {
+                    pool.apply(odd_pool, even_pool);
+                }
+                else
+                {
+                    pool.apply(even_pool, odd_pool);
+                }
+            }
+        }
+        ASSERT_FALSE(is_failed);
+        ASSERT_EQ(versions_count, pool.version());
+
+        pool.assign(NormalizedPool());
+        ASSERT_EQ(0u, pool.retired_count());
+    }
+
+} // anonymous namespace
@@ -0,0 +1,111 @@
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "diff_stats.h"
+#include "flat_pool.h"
+#include "normalized_pool.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+    constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+
+
+    TEST(TestDiffStats, TestCounts)
+    {
+        const Pool old_pool{{0, 10}, {5, 20}, {21, 30}, {100, 200}};
+        const Pool new_pool{{15, 15}, {150, 250}};
+        // Diff is {0, 14}, {16, 30}, {100, 149}
+        ASSERT_EQ((DiffStats{3, 80}), diff_stats(old_pool, new_pool));
+        ASSERT_EQ((DiffStats{3, 80}), diff_stats(FlatPool(old_pool), NormalizedPool(new_pool)));
+        ASSERT_EQ((DiffStats{0, 0}), diff_stats(new_pool, Pool{{0, upper_limit}}));
+        ASSERT_EQ((DiffStats{}), diff_stats(Pool{}, new_pool));
+
+        // The whole address space doesn't fit into 32 bits
+        ASSERT_EQ((DiffStats{1, std::uint64_t{1} << 32}), diff_stats(Pool{{0, upper_limit}}, Pool{}));
+    }
+
+
+    TEST(TestDiffStats, TestHistogram)
+    {
+        const Pool old_pool{{0x01FF0000, 0x03000009}, {0xFF000000, upper_limit}};
+        const Pool new_pool{{0xFF000000, 0xFF000000}};
+
+        std::array<std::uint64_t, 256> per_8{};
+        per_8[7] = 123;
+        ASSERT_EQ((DiffStats{2, 0x1010000 + 10 + 0xFFFFFF}), diff_stats(old_pool, new_pool, 8, per_8));
+        std::array<std::uint64_t, 256> expected_per_8{};
+        expected_per_8[1] = 0x10000;
+        expected_per_8[2] = 0x1000000;
+        expected_per_8[3] = 10;
+        expected_per_8[255] = 0xFFFFFF;
+        ASSERT_EQ(expected_per_8, per_8);
+
+        std::vector<std::uint64_t> per_16(65536);
+        diff_stats(old_pool, new_pool, 16, per_16);
+        ASSERT_EQ(0x10000u, per_16[0x01FF]);
+        ASSERT_EQ(0x10000u, per_16[0x0200]);
+        ASSERT_EQ(0x10000u, per_16[0x02FF]);
+        ASSERT_EQ(10u, per_16[0x0300]);
+        ASSERT_EQ(0xFFFFu, per_16[0xFF00]);
+        ASSERT_EQ(0x10000u, per_16[0xFFFF]);
+        ASSERT_EQ(0u, per_16[0x0301]);
+
+        std::array<std::uint64_t, 1> whole{};
+        diff_stats(Pool{{0, upper_limit}}, Pool{}, 0, whole);
+        ASSERT_EQ(std::uint64_t{1} << 32, whole[0]);
+
+        ASSERT_THROW(diff_stats(old_pool, new_pool, 16, per_8), std::invalid_argument);
+        std::vector<std::uint64_t> too_long(std::size_t{1} << 17);
+        ASSERT_THROW(diff_stats(old_pool, new_pool, 17, too_long), std::invalid_argument);
+    }
+
+
+    TEST(TestDiffStats, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348};
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            for (std::size_t step = 0; step < 20; ++step)
+            {
+                const Pool old_pool = makeRandomPool(gen, upper_limit, 100'000'000, 500);
+                const Pool new_pool = makeRandomPool(gen, upper_limit, 100'000'000, step * 50);
+
+                DiffStats expected;
+                std::array<std::uint64_t, 256> expected_histogram{};
+                for (const auto& [first, last] : find_diff(old_pool, new_pool))
+                {
+                    ++expected.ranges_count;
+                    expected.addresses_count += std::uint64_t{last} - first + 1;
+                    for (std::uint64_t address = first; address <= last; )
+                    {
+                        const std::uint64_t network_last = std::min<std::uint64_t>(last, address | 0xFFFFFF);
+                        expected_histogram[address >> 24] += network_last - address + 1;
+                        address = network_last + 1;
+                    }
+                }
+
+                std::array<std::uint64_t, 256> histogram{};
+                ASSERT_EQ(expected, diff_stats(old_pool, new_pool, 8, histogram));
+                ASSERT_EQ(expected_histogram, histogram);
+                ASSERT_EQ(expected, diff_stats(NormalizedPool(old_pool), FlatPool(new_pool)));
+                ASSERT_EQ(expected, diff_stats(FlatPool(old_pool), NormalizedPool(new_pool)));
+            }
+        }
+    }
+
+} // anonymous namespace
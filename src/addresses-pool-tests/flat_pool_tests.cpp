@@ -0,0 +1,207 @@
+#include <cstddef>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "flat_pool.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+
+    std::vector<Range> toVector(const Pool& pool)
+    {
+        return std::vector<Range>(pool.cbegin(), pool.cend());
+    }
+
+
+    TEST(TestFlatPool, TestConversions)
+    {
+        {
+            const Pool pool;
+            const FlatPool flat_pool(pool);
+            ASSERT_TRUE(flat_pool.empty());
+            ASSERT_EQ(pool, flat_pool.to_pool());
+        }
+
+        {
+            const Pool pool{{1, 17}, {6, 12}, {3, 28}, {1024, 5532}, {218, 333}, {195, 218}};
+            const FlatPool flat_pool(pool);
+            ASSERT_EQ(pool.size(), flat_pool.size());
+            ASSERT_EQ(toVector(pool), flat_pool.ranges());
+            ASSERT_EQ(pool, flat_pool.to_pool());
+        }
+
+        {
+            // Unsorted input with duplicates should end up the same as `Pool`
+            const std::vector<Range> ranges{{1024, 5532}, {1, 17}, {6, 12}, {1, 17}, {3, 28}, {6, 12}};
+            const FlatPool flat_pool(ranges);
+            const Pool pool(ranges.cbegin(), ranges.cend());
+            ASSERT_EQ(toVector(pool), flat_pool.ranges());
+            ASSERT_EQ(FlatPool(pool), flat_pool);
+        }
+    }
+
+
+    TEST(TestFlatPool, TestDiff)
+    {
+        constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+
+        {
+            const FlatPool old_addresses, new_addresses;
+            std::vector<Range> result;
+            find_diff(old_addresses, new_addresses, result);
+            ASSERT_TRUE(result.empty());
+        }
+
+        {
+            const FlatPool old_addresses(Pool{{1, 37}, {37, 89}, {80, 100}, {200, 300}});
+            const FlatPool new_addresses(Pool{
+                {10, 20}, {30, 40}, {50, 80}, {80, 110}, {50, 110}, {150, 180}, {190, 202}, {220, 235}
+            });
+            const std::vector<Range> what_result_should_be{
+                {1, 9}, {21, 29}, {41, 49}, {203, 219}, {236, 300}
+            };
+            std::vector<Range> result;
+            find_diff(old_addresses, new_addresses, result);
+            ASSERT_EQ(what_result_should_be, result);
+        }
+
+        {
+            const FlatPool old_addresses(Pool{{0, 0}, {0, 1}, {10, 50}, {100, upper_limit}});
+            const FlatPool new_addresses(Pool{{0, 2}, {11, 49}, {160, upper_limit}});
+            const std::vector<Range> what_result_should_be{{10, 10}, {50, 50}, {100, 159}};
+            std::vector<Range> result;
+            find_diff(old_addresses, new_addresses, result);
+            ASSERT_EQ(what_result_should_be, result);
+        }
+    }
+
+
+    TEST(TestFlatPool, TestDiffReusesOutput)
+    {
+        const FlatPool old_addresses(Pool{{3, 14}});
+        const FlatPool new_addresses(Pool{{7, 12}});
+
+        std::vector<Range> result{{1000, 2000}, {3000, 4000}, {5000, 6000}};
+        result.reserve(100);
+        const auto capacity = result.capacity();
+        const auto* const data = result.data();
+
+        find_diff(old_addresses, new_addresses, result);
+        const std::vector<Range> what_result_should_be{{3, 6}, {13, 14}};
+        ASSERT_EQ(what_result_should_be, result);
+        ASSERT_EQ(capacity, result.capacity());
+        ASSERT_EQ(data, result.data());
+    }
+
+
+    TEST(TestFlatPool, TestIsReduced)
+    {
+        ASSERT_TRUE(FlatPool().is_reduced());
+        ASSERT_TRUE(FlatPool(Pool{{1, 17}}).is_reduced());
+        ASSERT_TRUE(FlatPool(Pool{{1, 17}, {19, 20}, {100, 200}}).is_reduced());
+        // Adjacent
+        ASSERT_FALSE(FlatPool(Pool{{1, 17}, {18, 20}, {100, 200}}).is_reduced());
+        // Intersecting
+        ASSERT_FALSE(FlatPool(Pool{{1, 17}, {17, 20}}).is_reduced());
+        // Nested
+        ASSERT_FALSE(FlatPool(Pool{{1, 17}, {1, 20}}).is_reduced());
+        ASSERT_FALSE(FlatPool(std::vector<Range>{{100, 200}, {5, 10}, {7, 8}}).is_reduced());
+    }
+
+
+    TEST(TestFlatPool, TestGallopingDiff)
+    {
+        constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+
+        // Big reduced pool against a small one, in both directions
+        std::vector<Range> big_ranges;
+        for (IPAddress start = 0; start < 100'000; start += 10)
+        {
+            big_ranges.emplace_back(start, start + 4);
+        }
+        big_ranges.emplace_back(upper_limit - 10, upper_limit);
+        const FlatPool big_pool(big_ranges);
+        ASSERT_TRUE(big_pool.is_reduced());
+
+        const std::vector<Pool> small_pools{
+            {},
+            {{0, 0}},
+            {{3, 3}},
+            {{2, 12}},
+            {{5, 9}, {15, 19}},
+            {{0, upper_limit}},
+            {{77, 50'033}, {600, 700}, {50'030, 50'031}, {99'990, 99'999}},
+            {{50'000, 50'000}, {upper_limit - 5, upper_limit - 5}},
+            {{upper_limit, upper_limit}},
+            {{123'456, 1'000'000}}
+        };
+
+        for (const auto& small_pool : small_pools)
+        {
+            const Pool big_as_pool = big_pool.to_pool();
+            const FlatPool small_flat_pool(small_pool);
+
+            std::vector<Range> result;
+            find_diff(big_pool, small_flat_pool, result);
+            ASSERT_EQ(toVector(find_diff(big_as_pool, small_pool)), result);
+
+            find_diff(small_flat_pool, big_pool, result);
+            ASSERT_EQ(toVector(find_diff(small_pool, big_as_pool)), result);
+        }
+    }
+
+
+    TEST(TestFlatPool, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348, 8682340, 2096436};
+
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            for (const std::size_t pool_size : {1, 10, 100, 2000})
+            {
+                const Pool old_pool = makeRandomPool(gen, 10'000, 100, pool_size);
+                const Pool new_pool = makeRandomPool(gen, 10'000, 100, pool_size / 2 + 1);
+
+                std::vector<Range> result;
+                find_diff(FlatPool(old_pool), FlatPool(new_pool), result);
+                ASSERT_EQ(toVector(find_diff(old_pool, new_pool)), result);
+            }
+        }
+    }
+
+
+    TEST(TestFlatPool, PerformRandomizedGallopingTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348, 8682340, 2096436};
+
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            for (const std::size_t small_pool_size : {1, 2, 10, 60})
+            {
+                // Reduced big pool, small pool may have intersecting ranges
+                const Pool big_pool = find_diff(makeRandomPool(gen, 100'000, 30, 5000), Pool{});
+                const Pool small_pool = makeRandomPool(gen, 100'000, 3000, small_pool_size);
+                ASSERT_TRUE(FlatPool(big_pool).is_reduced());
+
+                std::vector<Range> result;
+                find_diff(FlatPool(big_pool), FlatPool(small_pool), result);
+                ASSERT_EQ(toVector(find_diff(big_pool, small_pool)), result);
+
+                find_diff(FlatPool(small_pool), FlatPool(big_pool), result);
+                ASSERT_EQ(toVector(find_diff(small_pool, big_pool)), result);
+            }
+        }
+    }
+
+} // anonymous namespace
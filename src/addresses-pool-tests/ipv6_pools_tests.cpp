@@ -0,0 +1,105 @@
+#include <cstddef>
+#include <cstdint>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ipv6_pools.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+
+    // IPv4 pool moved to [base, base + 2^32) of a wider address space.
+    // Diff of moved pools should be moved diff of the original ones.
+    template <typename Address>
+    BasicPool<Address> movePool(const Pool& pool, const Address& base)
+    {
+        BasicPool<Address> result;
+        for (const auto& range : pool)
+        {
+            result.emplace(base + Address{range.first}, base + Address{range.second});
+        }
+        return result;
+    }
+
+
+    template <typename Address>
+    void checkMovedDiffs(const Address& base)
+    {
+        constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+
+        const std::vector<std::pair<Pool, Pool>> pools{
+            {{}, {}},
+            {{{1, 37}, {37, 89}, {80, 100}, {200, 300}}, {{10, 20}, {30, 40}, {50, 80}, {80, 110}, {50, 110}, {150, 180}}},
+            {{{0, 0}, {0, 1}, {10, 50}, {100, upper_limit}}, {{0, 2}, {11, 49}, {160, upper_limit}}},
+            {{{0, upper_limit}}, {{0, 0}, {upper_limit, upper_limit}}},
+            {{{0, 5}, {6, 10}, {upper_limit - 3, upper_limit}}, {}}
+        };
+        for (const auto& [old_pool, new_pool] : pools)
+        {
+            ASSERT_EQ(
+                movePool(find_diff(old_pool, new_pool), base),
+                find_diff(movePool(old_pool, base), movePool(new_pool, base))
+            );
+        }
+
+        std::mt19937 gen(9055234);
+        for (const std::size_t pool_size : {1, 10, 100, 2000})
+        {
+            const Pool old_pool = makeRandomPool(gen, 10'000, 100, pool_size);
+            const Pool new_pool = makeRandomPool(gen, 10'000, 100, pool_size / 2 + 1);
+            ASSERT_EQ(
+                movePool(find_diff(old_pool, new_pool), base),
+                find_diff(movePool(old_pool, base), movePool(new_pool, base))
+            );
+        }
+    }
+
+
+    TEST(TestUint128, TestArithmetic)
+    {
+        constexpr std::uint64_t max_half = std::numeric_limits<std::uint64_t>::max();
+
+        static_assert(Uint128{0, max_half} + 1 == Uint128{1, 0});
+        static_assert(Uint128{1, 0} - 1 == Uint128{0, max_half});
+        static_assert(Uint128{max_half, max_half} + 1 == Uint128{});
+        static_assert(Uint128{} - 1 == Uint128{max_half, max_half});
+        static_assert(Uint128{5, 3} - Uint128{2, 7} == Uint128{2, max_half - 3});
+        static_assert(Uint128{1, 0} > Uint128{0, max_half});
+        static_assert(Uint128{0, 2} > 1);
+        static_assert(!(Uint128{0, 1} > 1));
+    }
+
+
+    TEST(TestIPv6Pools, TestDiff)
+    {
+        const IPv6Pool old_addresses{{1, 37}, {37, 89}, {80, 100}, {200, max_ipv6_address}};
+        const IPv6Pool new_addresses{{10, 20}, {30, 40}, {50, 80}, {250, max_ipv6_address - 1}};
+        const IPv6Pool what_result_should_be{{1, 9}, {21, 29}, {41, 49}, {81, 100}, {200, 249}, {max_ipv6_address, max_ipv6_address}};
+        ASSERT_EQ(what_result_should_be, find_diff(old_addresses, new_addresses));
+    }
+
+
+    TEST(TestIPv6Pools, PerformMovedPoolsTests)
+    {
+        constexpr std::uint64_t max_half = std::numeric_limits<std::uint64_t>::max();
+
+        // Ranges near zero, crossing the boundary of 64-bit halves and at the end of the address space
+        checkMovedDiffs(IPv6Address{0});
+        checkMovedDiffs(IPv6Address{max_half - 5000});
+        checkMovedDiffs(max_ipv6_address - IPv6Address{std::numeric_limits<IPAddress>::max()});
+
+        checkMovedDiffs(Uint128{0});
+        checkMovedDiffs(Uint128{0, max_half - 5000});
+        checkMovedDiffs(Uint128{max_half, max_half} - Uint128{std::numeric_limits<IPAddress>::max()});
+    }
+
+} // anonymous namespace
@@ -0,0 +1,130 @@
+#include <cstddef>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <random>
+#include <ranges>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "flat_pool.h"
+#include "lazy_diff.h"
+#include "normalized_pool.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+    constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+
+    static_assert(std::ranges::input_range<decltype(lazy_diff(Pool{}, Pool{}))>);
+    static_assert(std::ranges::view<decltype(lazy_diff(Pool{}, Pool{}))>);
+
+
+    template <typename Ranges>
+    std::vector<Range> collect(Ranges&& ranges)
+    {
+        std::vector<Range> result;
+        std::ranges::copy(ranges, std::back_inserter(result));
+        return result;
+    }
+
+
+    TEST(TestLazyDiff, TestRanges)
+    {
+        const Pool old_pool{{0, 9}, {5, 12}, {20, 30}, {40, 50}, {upper_limit - 1, upper_limit}};
+        const Pool new_pool{{2, 3}, {10, 25}, {40, 50}, {upper_limit, upper_limit}};
+        const std::vector<Range> expected{{0, 1}, {4, 9}, {26, 30}, {upper_limit - 1, upper_limit - 1}};
+
+        ASSERT_EQ(expected, collect(lazy_diff(old_pool, new_pool)));
+        ASSERT_EQ(expected, collect(lazy_diff(FlatPool(old_pool), NormalizedPool(new_pool))));
+        ASSERT_TRUE(collect(lazy_diff(Pool{}, new_pool)).empty());
+        ASSERT_EQ((std::vector<Range>{{0, 12}, {20, 30}}), collect(lazy_diff(old_pool, Pool{}) | std::views::take(2)));
+
+        // The first range which fits
+        auto diff = lazy_diff(old_pool, new_pool);
+        const auto iter = std::ranges::find_if(diff, [](const Range& range) { return range.second - range.first >= 4; });
+        ASSERT_EQ((Range{4, 9}), *iter);
+    }
+
+
+    TEST(TestLazyDiff, TestOnlyNeededRangesAreRead)
+    {
+        // Readers count ranges they give
+        std::size_t old_reads = 0;
+        std::size_t new_reads = 0;
+        const auto make_reader = [](const std::vector<Range>& ranges, std::size_t& reads)
+        {
+            return [&ranges, &reads, index = std::size_t{0}]() mutable -> std::optional<Range>
+            {
+                if (index == ranges.size())
+                {
+                    return std::nullopt;
+                }
+                ++reads;
+                return ranges[index++];
+            };
+        };
+        std::vector<Range> old_ranges{{0, 10}};
+        std::vector<Range> new_ranges{{5, 5}};
+        for (IPAddress first = 100; first < 100'000; first += 10)
+        {
+            old_ranges.emplace_back(first, first + 5);
+            new_ranges.emplace_back(first, first + 5);
+        }
+
+        using Reader = decltype(make_reader(old_ranges, old_reads));
+        LazyRanges diff(detail::DiffReader<Reader, Reader>(make_reader(old_ranges, old_reads), make_reader(new_ranges, new_reads)));
+        auto iter = diff.begin();
+        ASSERT_EQ((Range{0, 4}), *iter);
+        ASSERT_EQ(1u, old_reads);
+        ASSERT_EQ(1u, new_reads);
+        ++iter;
+        ASSERT_EQ((Range{6, 10}), *iter);
+        ASSERT_EQ(2u, old_reads);
+        ASSERT_EQ(2u, new_reads);
+        ++iter;
+        ASSERT_TRUE(iter == diff.end());
+    }
+
+
+    TEST(TestLazyDiff, TestIsSubset)
+    {
+        const Pool pool{{10, 20}, {30, 40}};
+        ASSERT_TRUE(is_subset(pool, Pool{{0, 25}, {26, 50}}));
+        ASSERT_TRUE(is_subset(pool, pool));
+        ASSERT_TRUE(is_subset(Pool{}, pool));
+        ASSERT_TRUE(is_subset(NormalizedPool(pool), FlatPool(Pool{{10, 15}, {16, 20}, {30, 40}})));
+        ASSERT_FALSE(is_subset(pool, Pool{{10, 20}, {30, 39}}));
+        ASSERT_FALSE(is_subset(pool, Pool{}));
+        ASSERT_FALSE(is_subset(Pool{{0, upper_limit}}, Pool{{1, upper_limit}}));
+    }
+
+
+    TEST(TestLazyDiff, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348};
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            for (std::size_t step = 0; step < 50; ++step)
+            {
+                const Pool old_pool = makeRandomPool(gen, 1'000'000, 1'000, 1'000);
+                const Pool new_pool = makeRandomPool(gen, 1'000'000, 1'000, step * 40);
+                const Pool expected = find_diff(old_pool, new_pool);
+
+                ASSERT_EQ(std::vector<Range>(expected.cbegin(), expected.cend()), collect(lazy_diff(old_pool, new_pool)));
+                ASSERT_EQ(std::vector<Range>(expected.cbegin(), expected.cend()), collect(lazy_diff(NormalizedPool(old_pool), FlatPool(new_pool))));
+                ASSERT_EQ(expected.empty(), is_subset(old_pool, new_pool));
+                ASSERT_TRUE(is_subset(expected, old_pool));
+            }
+        }
+    }
+
+} // anonymous namespace
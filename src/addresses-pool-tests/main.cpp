@@ -11,11 +11,13 @@
 #include <gtest/gtest.h>
 
 #include "ipv4_pools.h"
+#include "test_helpers.h"
 
 
 namespace
 {
     using namespace netup_tt;
+    using namespace netup_tt::tests;
 
 
     TEST(TestPool, TestAllEmpty) 
@@ -661,28 +663,6 @@ namespace
     }
 
 
-    Pool makeRandomFilledPool(
-        std::uniform_int_distribution<IPAddress>& range_start_distribution, 
-        std::uniform_int_distribution<IPAddress>& range_length_distribution, 
-        std::mt19937& generator, 
-        const IPAddress range_last_max, 
-        const std::size_t pool_size
-    )
-    {
-        Pool pool;
-        while (pool.size() < pool_size)
-        {
-            const auto range_start = range_start_distribution(generator);
-            const auto range_length = std::min(
-                range_last_max - range_start + 1, 
-                range_length_distribution(generator)
-            );
-            pool.emplace(range_start, range_start + range_length - 1);
-        }
-        return pool;
-    }
-
-
     TEST(TestPool, PerformRandomizedTests) 
     {
         const std::vector<std::size_t> seeds{9055234, 783423, 112348, 8682340, 2096436};
@@ -0,0 +1,142 @@
+#include <cstddef>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "flat_pool.h"
+#include "normalized_pool.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+
+    TEST(TestNormalizedPool, TestConstruction)
+    {
+        const Pool pool{
+            {1, 17}, {6, 12}, {3, 28}, {6, 17}, {2, 145}, {146, 146}, {147, 193},
+            {331, 689}, {1024, 5532}, {218, 333}, {332, 354}, {195, 218}
+        };
+        const std::vector<Range> what_result_should_be{{1, 193}, {195, 689}, {1024, 5532}};
+
+        ASSERT_TRUE(NormalizedPool().empty());
+        ASSERT_EQ(what_result_should_be, NormalizedPool(pool).ranges());
+        ASSERT_EQ(what_result_should_be, NormalizedPool(FlatPool(pool)).ranges());
+        ASSERT_EQ(what_result_should_be, NormalizedPool::from_reduced(what_result_should_be).ranges());
+        ASSERT_EQ(Pool(what_result_should_be.cbegin(), what_result_should_be.cend()), NormalizedPool(pool).to_pool());
+    }
+
+
+    TEST(TestNormalizedPool, TestInsert)
+    {
+        constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+
+        NormalizedPool pool;
+        pool.insert({100, 200});
+        pool.insert({300, 400});
+        pool.insert({10, 20});
+        ASSERT_EQ((std::vector<Range>{{10, 20}, {100, 200}, {300, 400}}), pool.ranges());
+
+        // Adjacent ranges are merged
+        pool.insert({21, 21});
+        pool.insert({99, 99});
+        ASSERT_EQ((std::vector<Range>{{10, 21}, {99, 200}, {300, 400}}), pool.ranges());
+
+        // Nested range changes nothing
+        pool.insert({150, 160});
+        ASSERT_EQ((std::vector<Range>{{10, 21}, {99, 200}, {300, 400}}), pool.ranges());
+
+        // Range which covers several ranges at once
+        pool.insert({50, 299});
+        ASSERT_EQ((std::vector<Range>{{10, 21}, {50, 400}}), pool.ranges());
+
+        pool.insert({upper_limit, upper_limit});
+        pool.insert({0, 0});
+        pool.insert({upper_limit - 1, upper_limit - 1});
+        ASSERT_EQ((std::vector<Range>{{0, 0}, {10, 21}, {50, 400}, {upper_limit - 1, upper_limit}}), pool.ranges());
+
+        pool.insert({1, upper_limit - 2});
+        ASSERT_EQ((std::vector<Range>{{0, upper_limit}}), pool.ranges());
+    }
+
+
+    TEST(TestNormalizedPool, TestDiff)
+    {
+        const Pool old_addresses{{1, 37}, {37, 89}, {80, 100}, {200, 300}};
+        const Pool new_addresses{
+            {10, 20}, {30, 40}, {50, 80}, {80, 110}, {50, 110}, {150, 180}, {190, 202}, {220, 235}
+        };
+        const NormalizedPool what_result_should_be = NormalizedPool(find_diff(old_addresses, new_addresses));
+
+        const NormalizedPool old_normalized(old_addresses), new_normalized(new_addresses);
+        ASSERT_EQ(what_result_should_be, find_diff(old_normalized, new_normalized));
+        ASSERT_EQ(what_result_should_be, find_diff(old_normalized, new_addresses));
+        ASSERT_EQ(what_result_should_be, find_diff(old_addresses, new_normalized));
+        ASSERT_EQ(what_result_should_be, find_diff(old_normalized, FlatPool(new_addresses)));
+        ASSERT_EQ(what_result_should_be, find_diff(FlatPool(old_addresses), new_normalized));
+
+        std::vector<Range> result;
+        find_diff(old_normalized, new_normalized, std::back_inserter(result));
+        ASSERT_EQ(what_result_should_be.ranges(), result);
+
+        result.clear();
+        find_diff(old_normalized, new_addresses, [&result](const Range& range) { result.push_back(range); });
+        ASSERT_EQ(what_result_should_be.ranges(), result);
+    }
+
+
+    TEST(TestNormalizedPool, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348, 8682340, 2096436};
+
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            // The same old pool is diffed against many new ones, big and small
+            const Pool old_pool = makeRandomPool(gen, 100'000, 100, 5000);
+            const NormalizedPool old_normalized(old_pool);
+
+            for (const std::size_t new_pool_size : {1, 10, 100, 1000, 5000, 20'000})
+            {
+                const Pool new_pool = makeRandomPool(gen, 100'000, 100, new_pool_size);
+                const NormalizedPool new_normalized(new_pool);
+
+                ASSERT_EQ(NormalizedPool(find_diff(old_pool, new_pool)), find_diff(old_normalized, new_normalized));
+                ASSERT_EQ(NormalizedPool(find_diff(new_pool, old_pool)), find_diff(new_normalized, old_normalized));
+                ASSERT_EQ(NormalizedPool(find_diff(old_pool, new_pool)), find_diff(old_normalized, new_pool));
+                ASSERT_EQ(NormalizedPool(find_diff(new_pool, old_pool)), find_diff(new_pool, old_normalized));
+            }
+        }
+    }
+
+
+    TEST(TestNormalizedPool, PerformRandomizedInsertTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348, 8682340, 2096436};
+
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            const Pool pool = makeRandomPool(gen, 10'000, 50, 1000);
+
+            // Insertion in random order gives the same result as construction from the whole pool
+            std::vector<Range> ranges(pool.cbegin(), pool.cend());
+            std::shuffle(ranges.begin(), ranges.end(), gen);
+            NormalizedPool incremental_pool;
+            for (const auto& range : ranges)
+            {
+                incremental_pool.insert(range);
+            }
+            ASSERT_EQ(NormalizedPool(pool), incremental_pool);
+        }
+    }
+
+} // anonymous namespace
@@ -0,0 +1,168 @@
+#include <cstddef>
+
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "flat_pool.h"
+#include "parallel_diff.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+
+    std::vector<Range> findDiffSequentially(const FlatPool& old_pool, const FlatPool& new_pool)
+    {
+        std::vector<Range> diff;
+        find_diff(old_pool, new_pool, diff);
+        return diff;
+    }
+
+
+    TEST(TestParallelDiff, TestSmallPoolsAreNotSplit)
+    {
+        const FlatPool old_addresses(Pool{{1, 37}, {40, 76}, {80, 100}, {200, 300}});
+        const FlatPool new_addresses(Pool{{10, 20}, {44, 57}, {85, 99}, {233, 287}});
+
+        std::size_t executor_calls = 0;
+        ParallelDiffOptions options;
+        options.slabs_count = 4;
+        options.executor = [&executor_calls](std::size_t, const std::function<void(std::size_t)>&)
+        {
+            ++executor_calls;
+        };
+
+        std::vector<Range> result;
+        find_diff_parallel(old_addresses, new_addresses, result, options);
+        ASSERT_EQ(findDiffSequentially(old_addresses, new_addresses), result);
+        ASSERT_EQ(0, executor_calls);
+    }
+
+
+    TEST(TestParallelDiff, TestRangesCrossingSlabs)
+    {
+        constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+
+        // Long ranges at the beginning cover all slabs, so everything is carried
+        // into the following slabs and diff ranges are glued back on slabs boundaries
+        const FlatPool old_addresses(Pool{
+            {0, upper_limit}, {10, 20}, {30, 40}, {50, 60}, {70, 80}, {90, 100}, {110, 120}, {130, 140}
+        });
+        const FlatPool new_addresses(Pool{
+            {5, 5}, {10, 11}, {45, 1000}, {50, 51}, {61, 61}, {200, 300}, {400, 400}, {1'000'000, upper_limit}
+        });
+
+        for (const std::size_t slabs_count : {2, 3, 4, 8})
+        {
+            ParallelDiffOptions options;
+            options.slabs_count = slabs_count;
+            options.min_slab_size = 1;
+
+            std::vector<Range> result;
+            find_diff_parallel(old_addresses, new_addresses, result, options);
+            ASSERT_EQ(findDiffSequentially(old_addresses, new_addresses), result);
+        }
+    }
+
+
+    TEST(TestParallelDiff, TestCustomExecutor)
+    {
+        std::mt19937 gen(783423);
+        const FlatPool old_addresses(makeRandomPool(gen, 100'000, 100, 5000));
+        const FlatPool new_addresses(makeRandomPool(gen, 100'000, 100, 3000));
+
+        std::atomic<std::size_t> tasks_done{0};
+        ParallelDiffOptions options;
+        options.slabs_count = 16;
+        options.min_slab_size = 100;
+        options.executor = [&tasks_done](const std::size_t tasks_count, const std::function<void(std::size_t)>& task)
+        {
+            // Tasks are run in reverse order to make sure they don't depend on each other
+            for (std::size_t index = tasks_count; index > 0; --index)
+            {
+                task(index - 1);
+                ++tasks_done;
+            }
+        };
+
+        std::vector<Range> result;
+        find_diff_parallel(old_addresses, new_addresses, result, options);
+        ASSERT_EQ(findDiffSequentially(old_addresses, new_addresses), result);
+        ASSERT_GT(tasks_done, 0);
+    }
+
+
+    TEST(TestParallelDiff, TestExceptionsArePropagated)
+    {
+        std::mt19937 gen(112348);
+        const FlatPool old_addresses(makeRandomPool(gen, 100'000, 100, 5000));
+        const FlatPool new_addresses(makeRandomPool(gen, 100'000, 100, 3000));
+
+        ParallelDiffOptions options;
+        options.slabs_count = 4;
+        options.min_slab_size = 100;
+        options.executor = [](std::size_t, const std::function<void(std::size_t)>&)
+        {
+            throw std::runtime_error("executor failure");
+        };
+
+        std::vector<Range> result;
+        ASSERT_THROW(find_diff_parallel(old_addresses, new_addresses, result, options), std::runtime_error);
+    }
+
+
+    TEST(TestParallelDiff, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348, 8682340, 2096436};
+
+        struct TestParams
+        {
+            IPAddress mask_size;
+            IPAddress range_max_len;
+            std::size_t old_pool_size;
+            std::size_t new_pool_size;
+        };
+
+        const std::vector<TestParams> tests_params
+        {
+            {1000, 40, 40, 40},
+            {10'000, 50, 300, 100},
+            {10'000, 10'000, 2000, 1},
+            {10'000, 100, 2000, 1000},
+            {1'000'000, 1000, 20'000, 20'000},
+            {std::numeric_limits<IPAddress>::max(), 1'000'000, 20'000, 5000}
+        };
+
+        for (const auto seed : seeds)
+        {
+            for (const auto& params : tests_params)
+            {
+                std::mt19937 gen(seed);
+                const FlatPool old_pool(makeRandomPool(gen, params.mask_size, params.range_max_len, params.old_pool_size));
+                const FlatPool new_pool(makeRandomPool(gen, params.mask_size, params.range_max_len, params.new_pool_size));
+                const auto what_result_should_be = findDiffSequentially(old_pool, new_pool);
+
+                for (const std::size_t slabs_count : {2, 7, 64})
+                {
+                    ParallelDiffOptions options;
+                    options.slabs_count = slabs_count;
+                    options.min_slab_size = 1;
+
+                    std::vector<Range> result;
+                    find_diff_parallel(old_pool, new_pool, result, options);
+                    ASSERT_EQ(what_result_should_be, result);
+                }
+            }
+        }
+    }
+
+} // anonymous namespace
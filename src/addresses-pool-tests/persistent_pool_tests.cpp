@@ -0,0 +1,135 @@
+#include <cstddef>
+
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "persistent_pool.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+    constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+
+
+    Pool reduce(const Pool& pool)
+    {
+        return find_diff(pool, Pool{});
+    }
+
+
+    TEST(TestPersistentPool, TestAddAndSubtract)
+    {
+        PersistentPool pool(Pool{{10, 20}, {15, 30}, {40, 50}, {upper_limit - 5, upper_limit}});
+        ASSERT_EQ((Pool{{10, 30}, {40, 50}, {upper_limit - 5, upper_limit}}), pool.to_pool());
+        ASSERT_EQ(3u, pool.size());
+
+        pool.add(Range{31, 35});
+        pool.add(Range{0, 0});
+        ASSERT_EQ((Pool{{0, 0}, {10, 35}, {40, 50}, {upper_limit - 5, upper_limit}}), pool.to_pool());
+        pool.add(Range{1, 45});
+        ASSERT_EQ((Pool{{0, 50}, {upper_limit - 5, upper_limit}}), pool.to_pool());
+
+        pool.subtract(Range{10, 19});
+        pool.subtract(Range{upper_limit, upper_limit});
+        ASSERT_EQ((Pool{{0, 9}, {20, 50}, {upper_limit - 5, upper_limit - 1}}), pool.to_pool());
+        pool.subtract(Range{5, upper_limit - 5});
+        ASSERT_EQ((std::vector<Range>{{0, 4}, {upper_limit - 4, upper_limit - 1}}), pool.ranges());
+
+        ASSERT_TRUE(pool.contains(4));
+        ASSERT_FALSE(pool.contains(5));
+        ASSERT_FALSE(pool.contains(upper_limit));
+
+        pool.subtract(Range{0, upper_limit});
+        ASSERT_TRUE(pool.empty());
+        pool.add(Range{0, upper_limit});
+        ASSERT_EQ((Pool{{0, upper_limit}}), pool.to_pool());
+    }
+
+
+    TEST(TestPersistentPool, TestSnapshots)
+    {
+        PersistentPool pool(Pool{{0, 10}, {20, 30}, {0x10000000, 0x10000010}});
+        const PersistentPool snapshot = pool;
+
+        pool.subtract(Range{5, 25});
+        pool.add(Range{0x20000000, 0x20000000});
+        ASSERT_EQ((Pool{{0, 10}, {20, 30}, {0x10000000, 0x10000010}}), snapshot.to_pool());
+
+        ASSERT_EQ((Pool{{5, 10}, {20, 25}}), find_diff(snapshot, pool));
+        ASSERT_EQ((Pool{{0x20000000, 0x20000000}}), find_diff(pool, snapshot));
+        ASSERT_TRUE(find_diff(pool, pool).empty());
+
+        std::vector<Range> removed;
+        std::vector<Range> added;
+        find_changed_ranges(snapshot, pool, removed, added);
+        ASSERT_EQ((std::vector<Range>{{0, 10}, {20, 30}}), removed);
+        ASSERT_EQ((std::vector<Range>{{0, 4}, {26, 30}, {0x20000000, 0x20000000}}), added);
+
+        // Shape doesn't depend on history, the same ranges are the same
+        pool.subtract(Range{0x20000000, 0x20000000});
+        pool.add(Range{5, 10});
+        pool.add(Range{20, 25});
+        find_changed_ranges(snapshot, pool, removed, added);
+        ASSERT_TRUE(removed.empty());
+        ASSERT_TRUE(added.empty());
+    }
+
+
+    TEST(TestPersistentPool, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348};
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            Pool expected = reduce(makeRandomPool(gen, 1'000'000, 1'000, 2'000));
+            PersistentPool pool(expected);
+            std::vector<std::pair<Pool, PersistentPool>> snapshots;
+            for (std::size_t step = 0; step < 100; ++step)
+            {
+                if (step % 10 == 0)
+                {
+                    snapshots.emplace_back(expected, pool);
+                }
+                const Pool update = makeRandomPool(gen, step % 3 == 0 ? upper_limit : 1'000'000, 3'000, step % 10 + 1);
+                for (const auto& range : update)
+                {
+                    if (step % 2 == 0)
+                    {
+                        pool.subtract(range);
+                    }
+                    else
+                    {
+                        pool.add(range);
+                    }
+                }
+                if (step % 2 == 0)
+                {
+                    expected = find_diff(expected, update);
+                }
+                else
+                {
+                    expected.insert(update.cbegin(), update.cend());
+                    expected = reduce(expected);
+                }
+                ASSERT_EQ(expected, pool.to_pool());
+                ASSERT_EQ(expected.size(), pool.size());
+            }
+
+            for (const auto& [expected_snapshot, snapshot] : snapshots)
+            {
+                ASSERT_EQ(expected_snapshot, snapshot.to_pool());
+                ASSERT_EQ(find_diff(expected_snapshot, expected), find_diff(snapshot, pool));
+                ASSERT_EQ(find_diff(expected, expected_snapshot), find_diff(pool, snapshot));
+            }
+        }
+    }
+
+} // anonymous namespace
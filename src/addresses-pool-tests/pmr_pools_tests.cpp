@@ -0,0 +1,135 @@
+#include <cstddef>
+
+#include <algorithm>
+#include <iterator>
+#include <memory_resource>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "pmr_pools.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+
+    // Counts allocations and takes memory from `upstream`
+    class CountingResource : public std::pmr::memory_resource
+    {
+    public:
+        explicit CountingResource(std::pmr::memory_resource* const upstream = std::pmr::new_delete_resource())
+            : upstream_(upstream)
+        {
+        }
+
+        std::size_t allocations() const noexcept { return allocations_; }
+        std::size_t deallocations() const noexcept { return deallocations_; }
+
+    private:
+        void* do_allocate(const std::size_t bytes, const std::size_t alignment) override
+        {
+            ++allocations_;
+            return upstream_->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* const ptr, const std::size_t bytes, const std::size_t alignment) override
+        {
+            ++deallocations_;
+            upstream_->deallocate(ptr, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+
+        std::pmr::memory_resource* upstream_;
+        std::size_t allocations_{0};
+        std::size_t deallocations_{0};
+    };
+
+
+    template <typename Address, typename Allocator>
+    Pool toPool(const BasicPool<Address, Allocator>& pool)
+    {
+        return Pool(pool.cbegin(), pool.cend());
+    }
+
+
+    TEST(TestPmrPools, TestResource)
+    {
+        const Pool old_pool{{1, 37}, {37, 89}, {80, 100}, {200, 300}};
+        const Pool new_pool{{10, 20}, {30, 40}, {50, 80}, {150, 180}, {190, 202}, {220, 235}};
+
+        CountingResource resource;
+        {
+            const pmr::Pool diff = find_diff(old_pool, new_pool, &resource);
+            ASSERT_EQ(find_diff(old_pool, new_pool), toPool(diff));
+            ASSERT_EQ(&resource, diff.get_allocator().resource());
+            // One node per range, nothing else
+            ASSERT_EQ(diff.size(), resource.allocations());
+        }
+        ASSERT_EQ(resource.allocations(), resource.deallocations());
+
+        // Input pools in an arena, diff in another resource
+        CountingResource upstream;
+        {
+            std::pmr::monotonic_buffer_resource arena(&upstream);
+            const pmr::Pool old_arena_pool(old_pool.cbegin(), old_pool.cend(), &arena);
+            const pmr::Pool new_arena_pool(new_pool.cbegin(), new_pool.cend(), &arena);
+            const std::size_t arena_allocations = upstream.allocations();
+            // Arena takes memory in big blocks
+            ASSERT_LT(arena_allocations, old_pool.size() + new_pool.size());
+
+            CountingResource diff_resource;
+            ASSERT_EQ(find_diff(old_pool, new_pool), toPool(find_diff(old_arena_pool, new_arena_pool, &diff_resource)));
+            ASSERT_EQ(find_diff(old_pool, new_pool), toPool(find_diff(old_arena_pool, new_pool, &diff_resource)));
+            ASSERT_EQ(arena_allocations, upstream.allocations());
+
+            std::vector<Range> diff;
+            find_diff(old_arena_pool, new_arena_pool, std::back_inserter(diff));
+            ASSERT_EQ(find_diff(old_pool, new_pool), Pool(diff.cbegin(), diff.cend()));
+        }
+        // Blocks are released at once with the arena
+        ASSERT_EQ(upstream.allocations(), upstream.deallocations());
+    }
+
+
+    TEST(TestPmrPools, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348};
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            const Pool old_pool = makeRandomPool(gen, 100'000, 1'000, 2'000);
+            const Pool new_pool = makeRandomPool(gen, 100'000, 1'000, 2'000);
+
+            std::pmr::monotonic_buffer_resource arena;
+            ASSERT_EQ(find_diff(old_pool, new_pool), toPool(find_diff(old_pool, new_pool, &arena)));
+
+            // Same for IPv6 addresses
+            pmr::IPv6Pool old_ipv6_pool(&arena), new_ipv6_pool(&arena);
+            for (const auto& [first, last] : old_pool)
+            {
+                old_ipv6_pool.emplace(IPv6Address{first}, IPv6Address{last});
+            }
+            for (const auto& [first, last] : new_pool)
+            {
+                new_ipv6_pool.emplace(IPv6Address{first}, IPv6Address{last});
+            }
+            const pmr::IPv6Pool ipv6_diff = find_diff(old_ipv6_pool, new_ipv6_pool, &arena);
+            const Pool diff = find_diff(old_pool, new_pool);
+            ASSERT_EQ(diff.size(), ipv6_diff.size());
+            ASSERT_TRUE(std::equal(diff.cbegin(), diff.cend(), ipv6_diff.cbegin(), [](const Range& range, const IPv6Range& ipv6_range)
+            {
+                return IPv6Address{range.first} == ipv6_range.first && IPv6Address{range.second} == ipv6_range.second;
+            }));
+        }
+    }
+
+} // anonymous namespace
@@ -0,0 +1,144 @@
+#include <cstddef>
+
+#include <limits>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "pool_algebra.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+    constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+
+    // Pools in tests are made of addresses below this, so they may be checked address by address
+    constexpr IPAddress addresses_count = 3'000;
+
+
+    std::vector<bool> toBits(const Pool& pool)
+    {
+        std::vector<bool> bits(addresses_count, false);
+        for (const auto& [first, last] : pool)
+        {
+            for (IPAddress address = first; address <= last; ++address)
+            {
+                bits[address] = true;
+            }
+        }
+        return bits;
+    }
+
+
+    Pool fromBits(const std::vector<bool>& bits)
+    {
+        Pool pool;
+        for (IPAddress address = 0; address < addresses_count; ++address)
+        {
+            if (bits[address])
+            {
+                const IPAddress first = address;
+                while (address + 1 < addresses_count && bits[address + 1])
+                {
+                    ++address;
+                }
+                pool.emplace(first, address);
+            }
+        }
+        return pool;
+    }
+
+
+    std::vector<const Pool*> pointers(const std::vector<Pool>& pools)
+    {
+        std::vector<const Pool*> result;
+        for (const auto& pool : pools)
+        {
+            result.push_back(&pool);
+        }
+        return result;
+    }
+
+
+    TEST(TestPoolAlgebra, TestSmallPools)
+    {
+        const Pool first_pool{{1, 37}, {37, 89}, {200, 300}};
+        const Pool second_pool{{10, 20}, {30, 40}, {90, 110}, {250, 260}};
+        const Pool third_pool{{0, 15}, {35, 250}};
+
+        const std::vector<const Pool*> pools{&first_pool, &second_pool, &third_pool};
+        ASSERT_EQ((Pool{{0, 300}}), find_union(pools));
+        ASSERT_EQ((Pool{{10, 15}, {35, 40}, {250, 250}}), find_intersection(pools));
+        ASSERT_EQ((Pool{{21, 29}, {261, 300}}), find_diff(first_pool, std::vector<const Pool*>{&third_pool, &second_pool, &third_pool}));
+
+        // Degenerate cases
+        ASSERT_EQ(Pool{}, find_union({}));
+        ASSERT_EQ(Pool{}, find_intersection({}));
+        ASSERT_EQ((Pool{{1, 89}, {200, 300}}), find_diff(first_pool, std::span<const Pool* const>{}));
+        ASSERT_EQ((Pool{{1, 89}, {200, 300}}), find_union(std::vector<const Pool*>{&first_pool}));
+        ASSERT_EQ((Pool{{1, 89}, {200, 300}}), find_intersection(std::vector<const Pool*>{&first_pool, &first_pool}));
+        const Pool empty_pool;
+        ASSERT_EQ(Pool{}, find_intersection(std::vector<const Pool*>{&first_pool, &empty_pool}));
+
+        // Edges of the address space
+        const Pool whole_pool{{0, upper_limit}};
+        const Pool top_pool{{upper_limit - 10, upper_limit}, {upper_limit, upper_limit}};
+        const Pool bottom_pool{{0, 0}, {0, 5}};
+        const std::vector<const Pool*> edge_pools{&top_pool, &bottom_pool};
+        ASSERT_EQ((Pool{{0, 5}, {upper_limit - 10, upper_limit}}), find_union(edge_pools));
+        ASSERT_EQ((Pool{{6, upper_limit - 11}}), find_diff(whole_pool, edge_pools));
+        ASSERT_EQ((Pool{{upper_limit - 10, upper_limit}}), find_intersection(std::vector<const Pool*>{&whole_pool, &top_pool}));
+    }
+
+
+    TEST(TestPoolAlgebra, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348};
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            for (const std::size_t pools_count : {1, 2, 3, 10})
+            {
+                std::vector<Pool> pools;
+                for (std::size_t index = 0; index < pools_count; ++index)
+                {
+                    // Big ranges, so that intersections of many pools aren't empty
+                    pools.push_back(makeRandomPool(gen, addresses_count - 500, 500, 20));
+                }
+                const Pool old_pool = makeRandomPool(gen, addresses_count - 500, 300, 30);
+
+                std::vector<bool> union_bits(addresses_count, false), intersection_bits(addresses_count, true);
+                for (const auto& pool : pools)
+                {
+                    const auto bits = toBits(pool);
+                    for (IPAddress address = 0; address < addresses_count; ++address)
+                    {
+                        union_bits[address] = union_bits[address] || bits[address];
+                        intersection_bits[address] = intersection_bits[address] && bits[address];
+                    }
+                }
+                auto diff_bits = toBits(old_pool);
+                for (IPAddress address = 0; address < addresses_count; ++address)
+                {
+                    diff_bits[address] = diff_bits[address] && !union_bits[address];
+                }
+
+                const auto pool_pointers = pointers(pools);
+                ASSERT_EQ(fromBits(union_bits), find_union(pool_pointers));
+                ASSERT_EQ(fromBits(intersection_bits), find_intersection(pool_pointers));
+                ASSERT_EQ(fromBits(diff_bits), find_diff(old_pool, pool_pointers));
+
+                std::vector<Range> streamed;
+                find_diff(old_pool, pool_pointers, [&streamed](const Range& range) { streamed.push_back(range); });
+                ASSERT_EQ(fromBits(diff_bits), Pool(streamed.cbegin(), streamed.cend()));
+            }
+        }
+    }
+
+} // anonymous namespace
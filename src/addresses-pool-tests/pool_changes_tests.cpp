@@ -0,0 +1,155 @@
+#include <cstddef>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "flat_pool.h"
+#include "normalized_pool.h"
+#include "pool_changes.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+
+    Pool findIntersection(const Pool& first_pool, const Pool& second_pool)
+    {
+        return find_diff(first_pool, find_diff(first_pool, second_pool));
+    }
+
+
+    TEST(TestPoolChanges, TestEmpty)
+    {
+        const Pool pool{{1, 17}, {6, 12}, {100, 200}};
+
+        {
+            const auto changes = find_changes(Pool{}, Pool{}, true);
+            ASSERT_TRUE(changes.removed.empty());
+            ASSERT_TRUE(changes.added.empty());
+            ASSERT_TRUE(changes.unchanged.empty());
+        }
+
+        {
+            const auto changes = find_changes(pool, Pool{}, true);
+            ASSERT_EQ((Pool{{1, 17}, {100, 200}}), changes.removed);
+            ASSERT_TRUE(changes.added.empty());
+            ASSERT_TRUE(changes.unchanged.empty());
+        }
+
+        {
+            const auto changes = find_changes(Pool{}, pool, true);
+            ASSERT_TRUE(changes.removed.empty());
+            ASSERT_EQ((Pool{{1, 17}, {100, 200}}), changes.added);
+            ASSERT_TRUE(changes.unchanged.empty());
+        }
+
+        {
+            const auto changes = find_changes(pool, pool, true);
+            ASSERT_TRUE(changes.removed.empty());
+            ASSERT_TRUE(changes.added.empty());
+            ASSERT_EQ((Pool{{1, 17}, {100, 200}}), changes.unchanged);
+        }
+    }
+
+
+    TEST(TestPoolChanges, TestChanges)
+    {
+        constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+
+        {
+            // old: -----[* * * * * *]---[* * * * * * * *]---[* * * * *]----
+            // new: -------------[* * * * * *]-------[* * * * * * *]--------
+            const Pool old_addresses{{1, 37}, {40, 76}, {80, 100}};
+            const Pool new_addresses{{10, 50}, {60, 95}};
+            const auto changes = find_changes(old_addresses, new_addresses, true);
+            ASSERT_EQ((Pool{{1, 9}, {51, 59}, {96, 100}}), changes.removed);
+            ASSERT_EQ((Pool{{38, 39}, {77, 79}}), changes.added);
+            ASSERT_EQ((Pool{{10, 37}, {40, 50}, {60, 76}, {80, 95}}), changes.unchanged);
+        }
+
+        {
+            const Pool old_addresses{{0, 0}, {0, 1}, {10, 50}, {100, upper_limit}};
+            const Pool new_addresses{{0, 2}, {11, 49}, {60, 70}, {160, upper_limit}};
+            const auto changes = find_changes(old_addresses, new_addresses, true);
+            ASSERT_EQ((Pool{{10, 10}, {50, 50}, {100, 159}}), changes.removed);
+            ASSERT_EQ((Pool{{2, 2}, {60, 70}}), changes.added);
+            ASSERT_EQ((Pool{{0, 1}, {11, 49}, {160, upper_limit}}), changes.unchanged);
+        }
+
+        {
+            // Intersection isn't collected unless requested
+            const auto changes = find_changes(Pool{{0, 100}}, Pool{{50, 150}});
+            ASSERT_EQ((Pool{{0, 49}}), changes.removed);
+            ASSERT_EQ((Pool{{101, 150}}), changes.added);
+            ASSERT_TRUE(changes.unchanged.empty());
+        }
+    }
+
+
+    TEST(TestPoolChanges, TestStreaming)
+    {
+        const Pool old_addresses{{1, 37}, {37, 89}, {80, 100}, {200, 300}};
+        const Pool new_addresses{{10, 20}, {30, 40}, {50, 80}, {80, 110}, {190, 202}, {220, 235}};
+
+        std::vector<Range> removed, added;
+        std::size_t unchanged_count = 0;
+        find_changes(
+            NormalizedPool(old_addresses),
+            FlatPool(new_addresses),
+            [&removed](const Range& range) { removed.push_back(range); },
+            [&added](const Range& range) { added.push_back(range); },
+            [&unchanged_count](const Range&) { ++unchanged_count; }
+        );
+
+        const auto what_removed_should_be = find_diff(old_addresses, new_addresses);
+        const auto what_added_should_be = find_diff(new_addresses, old_addresses);
+        ASSERT_EQ(std::vector<Range>(what_removed_should_be.cbegin(), what_removed_should_be.cend()), removed);
+        ASSERT_EQ(std::vector<Range>(what_added_should_be.cbegin(), what_added_should_be.cend()), added);
+        ASSERT_EQ(findIntersection(old_addresses, new_addresses).size(), unchanged_count);
+    }
+
+
+    TEST(TestPoolChanges, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348, 8682340, 2096436};
+
+        struct TestParams
+        {
+            IPAddress mask_size;
+            IPAddress range_max_len;
+            std::size_t old_pool_size;
+            std::size_t new_pool_size;
+        };
+
+        const std::vector<TestParams> tests_params
+        {
+            {1000, 40, 40, 40},
+            {10'000, 50, 300, 100},
+            {10'000, 10'000, 2000, 1},
+            {10'000, 10'000, 1, 2000},
+            {10'000, 100, 2000, 1000}
+        };
+
+        for (const auto seed : seeds)
+        {
+            for (const auto& params : tests_params)
+            {
+                std::mt19937 gen(seed);
+                const Pool old_pool = makeRandomPool(gen, params.mask_size, params.range_max_len, params.old_pool_size);
+                const Pool new_pool = makeRandomPool(gen, params.mask_size, params.range_max_len, params.new_pool_size);
+
+                const auto changes = find_changes(old_pool, new_pool, true);
+                ASSERT_EQ(find_diff(old_pool, new_pool), changes.removed);
+                ASSERT_EQ(find_diff(new_pool, old_pool), changes.added);
+                ASSERT_EQ(findIntersection(old_pool, new_pool), changes.unchanged);
+            }
+        }
+    }
+
+} // anonymous namespace
@@ -0,0 +1,123 @@
+#include <cstddef>
+#include <cstdint>
+
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "pool_classifier.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+
+    // Scalar reference: walks over all reduced ranges
+    std::vector<std::uint32_t> classifyNaively(const std::vector<Range>& ranges, const std::vector<IPAddress>& addresses)
+    {
+        std::vector<std::uint32_t> range_indexes(addresses.size(), PoolClassifier::not_found);
+        for (std::size_t i = 0; i < addresses.size(); ++i)
+        {
+            for (std::size_t index = 0; index < ranges.size(); ++index)
+            {
+                if (ranges[index].first <= addresses[i] && addresses[i] <= ranges[index].second)
+                {
+                    range_indexes[i] = static_cast<std::uint32_t>(index);
+                }
+            }
+        }
+        return range_indexes;
+    }
+
+
+    std::vector<std::uint32_t> classify(
+        const PoolClassifier& classifier,
+        const std::vector<IPAddress>& addresses,
+        const PoolClassifier::Kernel kernel
+    )
+    {
+        std::vector<std::uint32_t> range_indexes(addresses.size());
+        classifier.classify(addresses, range_indexes, kernel);
+        return range_indexes;
+    }
+
+
+    constexpr PoolClassifier::Kernel all_kernels[] = {
+        PoolClassifier::Kernel::automatic,
+        PoolClassifier::Kernel::scalar,
+        PoolClassifier::Kernel::avx2
+    };
+
+
+    TEST(TestPoolClassifier, TestEmpty)
+    {
+        const std::vector<IPAddress> addresses{0, 1, 2, 3, 4, 5, 6, 7, 8, std::numeric_limits<IPAddress>::max()};
+        const std::vector<std::uint32_t> what_result_should_be(addresses.size(), PoolClassifier::not_found);
+        for (const auto kernel : all_kernels)
+        {
+            ASSERT_EQ(what_result_should_be, classify(PoolClassifier(), addresses, kernel));
+            ASSERT_EQ(what_result_should_be, classify(PoolClassifier(Pool{}), addresses, kernel));
+        }
+    }
+
+
+    TEST(TestPoolClassifier, TestClassify)
+    {
+        constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+        constexpr auto not_found = PoolClassifier::not_found;
+
+        const PoolClassifier classifier(Pool{{0, 5}, {3, 9}, {20, 20}, {100, 2'000'000'000}, {3'000'000'000, upper_limit}});
+        const std::vector<Range> what_ranges_should_be{{0, 9}, {20, 20}, {100, 2'000'000'000}, {3'000'000'000, upper_limit}};
+        ASSERT_EQ(what_ranges_should_be, classifier.ranges());
+
+        // 11 addresses, so the vectorized kernel leaves a tail for the scalar one
+        const std::vector<IPAddress> addresses{
+            0, 9, 10, 19, 20, 21, 2'000'000'000, 2'000'000'001, 2'999'999'999, 3'000'000'000, upper_limit
+        };
+        const std::vector<std::uint32_t> what_result_should_be{
+            0, 0, not_found, not_found, 1, not_found, 2, not_found, not_found, 3, 3
+        };
+        for (const auto kernel : all_kernels)
+        {
+            ASSERT_EQ(what_result_should_be, classify(classifier, addresses, kernel));
+        }
+
+        std::vector<std::uint32_t> too_small(addresses.size() - 1);
+        ASSERT_THROW(classifier.classify(addresses, too_small), std::invalid_argument);
+    }
+
+
+    TEST(TestPoolClassifier, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348, 8682340, 2096436};
+
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            for (const std::size_t pool_size : {1, 2, 3, 7, 8, 9, 100, 1000, 5000})
+            {
+                const PoolClassifier classifier(makeRandomPool(gen, 100'000, 30, pool_size));
+
+                std::uniform_int_distribution<IPAddress> address_distribution(0, 100'100);
+                std::vector<IPAddress> addresses(1003);
+                for (auto& address : addresses)
+                {
+                    address = address_distribution(gen);
+                }
+
+                const auto what_result_should_be = classifyNaively(classifier.ranges(), addresses);
+                for (const auto kernel : all_kernels)
+                {
+                    ASSERT_EQ(what_result_should_be, classify(classifier, addresses, kernel));
+                }
+            }
+        }
+    }
+
+} // anonymous namespace
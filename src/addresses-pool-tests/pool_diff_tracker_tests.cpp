@@ -0,0 +1,108 @@
+#include <cstddef>
+
+#include <iterator>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "pool_diff_tracker.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+
+    void checkDiff(const PoolDiffTracker& tracker)
+    {
+        ASSERT_EQ(find_diff(tracker.old_pool(), tracker.new_pool()), tracker.diff());
+    }
+
+
+    TEST(TestPoolDiffTracker, TestEmpty)
+    {
+        PoolDiffTracker tracker;
+        ASSERT_TRUE(tracker.diff().empty());
+        ASSERT_FALSE(tracker.erase_old({1, 2}));
+        ASSERT_FALSE(tracker.erase_new({1, 2}));
+        ASSERT_TRUE(tracker.diff().empty());
+    }
+
+
+    TEST(TestPoolDiffTracker, TestUpdates)
+    {
+        constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+
+        PoolDiffTracker tracker(Pool{{1, 37}, {37, 89}, {80, 100}, {200, 300}}, Pool{{10, 20}, {30, 40}});
+        ASSERT_EQ((Pool{{1, 9}, {21, 29}, {41, 100}, {200, 300}}), tracker.diff());
+
+        // Range which is already in the pool changes nothing
+        ASSERT_FALSE(tracker.insert_old({37, 89}));
+        ASSERT_FALSE(tracker.insert_new({10, 20}));
+
+        // Splits a diff range
+        ASSERT_TRUE(tracker.insert_new({50, 60}));
+        ASSERT_EQ((Pool{{1, 9}, {21, 29}, {41, 49}, {61, 100}, {200, 300}}), tracker.diff());
+
+        // Bridges two diff ranges
+        ASSERT_TRUE(tracker.insert_old({101, 199}));
+        ASSERT_EQ((Pool{{1, 9}, {21, 29}, {41, 49}, {61, 300}}), tracker.diff());
+
+        // Erasing a range doesn't uncover addresses which are covered by other ranges
+        ASSERT_TRUE(tracker.erase_new({30, 40}));
+        ASSERT_EQ((Pool{{1, 9}, {21, 49}, {61, 300}}), tracker.diff());
+        ASSERT_TRUE(tracker.erase_old({37, 89}));
+        ASSERT_EQ((Pool{{1, 9}, {21, 37}, {80, 300}}), tracker.diff());
+        ASSERT_FALSE(tracker.erase_old({37, 89}));
+
+        // The whole address space
+        ASSERT_TRUE(tracker.insert_old({0, upper_limit}));
+        ASSERT_EQ((Pool{{0, 9}, {21, 49}, {61, upper_limit}}), tracker.diff());
+        ASSERT_TRUE(tracker.insert_new({upper_limit, upper_limit}));
+        ASSERT_TRUE(tracker.insert_new({0, 0}));
+        ASSERT_EQ((Pool{{1, 9}, {21, 49}, {61, upper_limit - 1}}), tracker.diff());
+        ASSERT_TRUE(tracker.insert_new({0, upper_limit}));
+        ASSERT_TRUE(tracker.diff().empty());
+        ASSERT_TRUE(tracker.erase_old({0, upper_limit}));
+        ASSERT_TRUE(tracker.erase_new({0, upper_limit}));
+        ASSERT_EQ((Pool{{1, 9}, {21, 37}, {80, 300}}), tracker.diff());
+        checkDiff(tracker);
+    }
+
+
+    TEST(TestPoolDiffTracker, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348, 8682340, 2096436};
+
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            PoolDiffTracker tracker(makeRandomPool(gen, 10'000, 100, 300), makeRandomPool(gen, 10'000, 100, 150));
+            checkDiff(tracker);
+
+            std::uniform_int_distribution<int> operation_distribution(0, 3);
+            for (std::size_t step = 0; step < 1000; ++step)
+            {
+                const bool is_old = operation_distribution(gen) % 2 == 0;
+                const Pool& pool = is_old ? tracker.old_pool() : tracker.new_pool();
+                if (operation_distribution(gen) < 2 || pool.empty())
+                {
+                    const Range range = *makeRandomPool(gen, 10'000, 300, 1).cbegin();
+                    is_old ? tracker.insert_old(range) : tracker.insert_new(range);
+                }
+                else
+                {
+                    std::uniform_int_distribution<std::size_t> index_distribution(0, pool.size() - 1);
+                    const Range range = *std::next(pool.cbegin(), static_cast<std::ptrdiff_t>(index_distribution(gen)));
+                    ASSERT_TRUE(is_old ? tracker.erase_old(range) : tracker.erase_new(range));
+                }
+                checkDiff(tracker);
+            }
+        }
+    }
+
+} // anonymous namespace
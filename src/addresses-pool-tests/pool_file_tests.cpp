@@ -0,0 +1,209 @@
+#include <cstddef>
+#include <cstdint>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "pool_file.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+
+    // File in the temporary directory which is removed when goes out of scope
+    class TemporaryFile
+    {
+    public:
+        explicit TemporaryFile(const std::string& name)
+            : path_(std::filesystem::temp_directory_path() / ("netup_tt_" + name + ".pool"))
+        {
+        }
+
+        ~TemporaryFile()
+        {
+            std::error_code ignored;
+            std::filesystem::remove(path_, ignored);
+        }
+
+        TemporaryFile(const TemporaryFile&) = delete;
+        TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+        const std::filesystem::path& path() const noexcept { return path_; }
+
+    private:
+        std::filesystem::path path_;
+    };
+
+
+    std::vector<Range> diffFiles(const MappedPoolFile& old_pool, const MappedPoolFile& new_pool)
+    {
+        std::vector<Range> result;
+        find_diff(old_pool, new_pool, std::back_inserter(result));
+        return result;
+    }
+
+
+    std::vector<Range> toVector(const Pool& pool)
+    {
+        return std::vector<Range>(pool.cbegin(), pool.cend());
+    }
+
+
+    TEST(TestPoolFile, TestWriteAndRead)
+    {
+        constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+        const TemporaryFile file("write_and_read");
+
+        {
+            write_pool_file(file.path(), Pool{});
+            const MappedPoolFile pool(file.path());
+            ASSERT_TRUE(pool.empty());
+            ASSERT_TRUE(pool.is_normalized());
+            ASSERT_EQ(16, std::filesystem::file_size(file.path()));
+        }
+
+        {
+            const Pool what_pool_should_be{{0, 0}, {1, 17}, {6, 12}, {3, 28}, {1024, 5532}, {upper_limit, upper_limit}};
+            write_pool_file(file.path(), what_pool_should_be);
+            const MappedPoolFile pool(file.path());
+            ASSERT_FALSE(pool.is_normalized());
+            ASSERT_EQ(what_pool_should_be.size(), pool.size());
+            ASSERT_EQ(what_pool_should_be, pool.to_pool());
+            ASSERT_EQ(16 + 8 * what_pool_should_be.size(), std::filesystem::file_size(file.path()));
+        }
+
+        {
+            const Pool reduced_pool{{0, 5}, {7, 17}, {upper_limit, upper_limit}};
+            write_pool_file(file.path(), reduced_pool);
+            ASSERT_TRUE(MappedPoolFile(file.path()).is_normalized());
+
+            write_pool_file(file.path(), FlatPool(reduced_pool));
+            ASSERT_TRUE(MappedPoolFile(file.path()).is_normalized());
+
+            write_pool_file(file.path(), NormalizedPool(Pool{{1, 17}, {6, 12}, {3, 28}}));
+            const MappedPoolFile pool(file.path());
+            ASSERT_TRUE(pool.is_normalized());
+            ASSERT_EQ((Pool{{1, 28}}), pool.to_pool());
+        }
+    }
+
+
+    TEST(TestPoolFile, TestInvalidFiles)
+    {
+        const TemporaryFile file("invalid");
+        const auto write_bytes = [&file](const std::vector<char>& bytes)
+        {
+            std::ofstream stream(file.path(), std::ios::binary | std::ios::trunc);
+            stream.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        };
+
+        ASSERT_THROW(MappedPoolFile(file.path()), std::system_error);
+
+        write_bytes({});
+        ASSERT_THROW(MappedPoolFile(file.path()), PoolFileError);
+
+        // Good header of one range
+        const std::vector<char> header{'N', 'T', 'P', 'L', 1, 0, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0};
+        const std::vector<char> range{1, 0, 0, 0, 2, 0, 0, 0};
+
+        auto bytes = header;
+        bytes.insert(bytes.end(), range.cbegin(), range.cend());
+        write_bytes(bytes);
+        ASSERT_EQ((Pool{{1, 2}}), MappedPoolFile(file.path()).to_pool());
+
+        // Wrong magic
+        bytes[0] = 'X';
+        write_bytes(bytes);
+        ASSERT_THROW(MappedPoolFile(file.path()), PoolFileError);
+        bytes[0] = 'N';
+
+        // Unknown version
+        bytes[4] = 2;
+        write_bytes(bytes);
+        ASSERT_THROW(MappedPoolFile(file.path()), PoolFileError);
+        bytes[4] = 1;
+
+        // Unknown flags
+        bytes[6] = 3;
+        write_bytes(bytes);
+        ASSERT_THROW(MappedPoolFile(file.path()), PoolFileError);
+        bytes[6] = 1;
+
+        // Truncated ranges
+        bytes.pop_back();
+        write_bytes(bytes);
+        ASSERT_THROW(MappedPoolFile(file.path()), PoolFileError);
+
+        // More ranges than declared
+        bytes = header;
+        bytes.insert(bytes.end(), range.cbegin(), range.cend());
+        bytes.insert(bytes.end(), range.cbegin(), range.cend());
+        write_bytes(bytes);
+        ASSERT_THROW(MappedPoolFile(file.path()), PoolFileError);
+    }
+
+
+    TEST(TestPoolFile, TestDiff)
+    {
+        const TemporaryFile old_file("diff_old"), new_file("diff_new");
+
+        const Pool old_addresses{{1, 37}, {37, 89}, {80, 100}, {200, 300}};
+        const Pool new_addresses{{10, 20}, {30, 40}, {50, 80}, {80, 110}, {50, 110}, {150, 180}, {190, 202}, {220, 235}};
+        write_pool_file(old_file.path(), old_addresses);
+        write_pool_file(new_file.path(), new_addresses);
+
+        const std::vector<Range> what_result_should_be{{1, 9}, {21, 29}, {41, 49}, {203, 219}, {236, 300}};
+        ASSERT_EQ(what_result_should_be, diffFiles(MappedPoolFile(old_file.path()), MappedPoolFile(new_file.path())));
+    }
+
+
+    TEST(TestPoolFile, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348};
+        const TemporaryFile old_file("randomized_old"), new_file("randomized_new");
+
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            // The last sizes are lopsided, so galloping is used
+            for (const auto& [old_size, new_size] : std::vector<std::pair<std::size_t, std::size_t>>{
+                {1, 1}, {100, 50}, {2000, 1000}, {5000, 10}, {10, 5000}
+            })
+            {
+                const Pool old_pool = makeRandomPool(gen, 100'000, 30, old_size);
+                const Pool new_pool = makeRandomPool(gen, 100'000, 3000, new_size);
+
+                for (const bool normalized : {false, true})
+                {
+                    if (normalized)
+                    {
+                        write_pool_file(old_file.path(), NormalizedPool(old_pool));
+                        write_pool_file(new_file.path(), NormalizedPool(new_pool));
+                    }
+                    else
+                    {
+                        write_pool_file(old_file.path(), old_pool);
+                        write_pool_file(new_file.path(), new_pool);
+                    }
+                    ASSERT_EQ(
+                        toVector(find_diff(old_pool, new_pool)),
+                        diffFiles(MappedPoolFile(old_file.path()), MappedPoolFile(new_file.path()))
+                    );
+                }
+            }
+        }
+    }
+
+} // anonymous namespace
@@ -0,0 +1,135 @@
+#include <cstddef>
+#include <cstdint>
+
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "pool_index.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+
+    // Reference implementation which walks over the reduced pool
+    bool naiveContains(const Pool& reduced_pool, const IPAddress address)
+    {
+        for (const auto& range : reduced_pool)
+        {
+            if (range.first <= address && address <= range.second)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+    bool isBitSet(const std::vector<std::uint64_t>& bitmask, const std::size_t index)
+    {
+        return (bitmask[index / 64] >> (index % 64)) & 1;
+    }
+
+
+    TEST(TestPoolIndex, TestEmpty)
+    {
+        const PoolIndex index;
+        ASSERT_TRUE(index.empty());
+        ASSERT_FALSE(index.contains(0));
+        ASSERT_FALSE(index.contains(1));
+        ASSERT_FALSE(index.contains(std::numeric_limits<IPAddress>::max()));
+
+        ASSERT_TRUE(PoolIndex(Pool{}).empty());
+        ASSERT_FALSE(PoolIndex(Pool{}).contains(0));
+    }
+
+
+    TEST(TestPoolIndex, TestContains)
+    {
+        constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+
+        const Pool pool{{0, 0}, {1, 17}, {6, 12}, {3, 28}, {30, 30}, {195, 218}, {218, 333}, {upper_limit, upper_limit}};
+        const PoolIndex index(pool);
+        // {0, 28}, {30, 30}, {195, 333}, {upper_limit, upper_limit}
+        ASSERT_EQ(4, index.size());
+
+        for (const IPAddress address : {0u, 1u, 17u, 28u, 30u, 195u, 200u, 333u, upper_limit})
+        {
+            ASSERT_TRUE(index.contains(address)) << address;
+        }
+        for (const IPAddress address : {29u, 31u, 194u, 334u, 100'000u, upper_limit - 1})
+        {
+            ASSERT_FALSE(index.contains(address)) << address;
+        }
+    }
+
+
+    TEST(TestPoolIndex, TestBatchContains)
+    {
+        const PoolIndex index(Pool{{10, 20}, {40, 40}, {1000, 2000}});
+
+        std::vector<IPAddress> addresses;
+        for (IPAddress address = 0; address < 150; ++address)
+        {
+            addresses.push_back(address * 15);
+        }
+
+        // Garbage in the bitmask is overwritten, including unused bits of the last word
+        std::vector<std::uint64_t> bitmask(3, ~std::uint64_t{0});
+        index.contains(addresses, bitmask);
+        for (std::size_t i = 0; i < addresses.size(); ++i)
+        {
+            ASSERT_EQ(index.contains(addresses[i]), isBitSet(bitmask, i)) << addresses[i];
+        }
+        ASSERT_EQ(0, bitmask[2] >> (addresses.size() % 64));
+
+        std::vector<std::uint64_t> too_small(2);
+        ASSERT_THROW(index.contains(addresses, too_small), std::invalid_argument);
+
+        // Nothing to look up, nothing to write
+        index.contains({}, std::span<std::uint64_t>{});
+    }
+
+
+    TEST(TestPoolIndex, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348, 8682340, 2096436};
+
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            // Sizes around powers of two make the last level of the tree full, almost empty and so on
+            for (const std::size_t pool_size : {1, 2, 3, 7, 8, 9, 100, 255, 256, 257, 2000})
+            {
+                const Pool pool = makeRandomPool(gen, 50'000, 20, pool_size);
+                const Pool reduced_pool = find_diff(pool, Pool{});
+                const PoolIndex index(pool);
+                ASSERT_EQ(reduced_pool.size(), index.size());
+
+                std::uniform_int_distribution<IPAddress> address_distribution(0, 50'100);
+                std::vector<IPAddress> addresses(1000);
+                for (auto& address : addresses)
+                {
+                    address = address_distribution(gen);
+                }
+
+                std::vector<std::uint64_t> bitmask((addresses.size() + 63) / 64);
+                index.contains(addresses, bitmask);
+                for (std::size_t i = 0; i < addresses.size(); ++i)
+                {
+                    const bool expected = naiveContains(reduced_pool, addresses[i]);
+                    ASSERT_EQ(expected, index.contains(addresses[i])) << addresses[i];
+                    ASSERT_EQ(expected, isBitSet(bitmask, i)) << addresses[i];
+                }
+            }
+        }
+    }
+
+} // anonymous namespace
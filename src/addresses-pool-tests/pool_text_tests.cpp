@@ -0,0 +1,146 @@
+#include <cstdint>
+
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "cidr.h"
+#include "pool_text.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+    constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+    const std::vector<AddressParser> parsers{AddressParser::scalar, AddressParser::ssse3};
+
+
+    std::string formatAddress(const IPAddress address)
+    {
+        return std::to_string(address >> 24) + '.' + std::to_string((address >> 16) & 0xFF) + '.'
+            + std::to_string((address >> 8) & 0xFF) + '.' + std::to_string(address & 0xFF);
+    }
+
+
+    std::size_t errorLine(const std::string& text, const AddressParser parser)
+    {
+        try
+        {
+            parse_pool_text(text, parser);
+        }
+        catch (const PoolTextError& error)
+        {
+            return error.line();
+        }
+        return 0;
+    }
+
+
+    TEST(TestPoolText, TestForms)
+    {
+        // Long lines go to the SSSE3 parser, the last short ones to the scalar one
+        const std::string text =
+            "10.0.0.1-10.0.0.200\n"
+            "192.168.0.0/16\r\n"
+            "\n"
+            "172.16.5.4\n"
+            "0.0.0.0/0\n"
+            "255.255.255.255\n"
+            "1.2.3.4";
+        const FlatPool expected(std::vector<Range>{
+            {0x0A000001, 0x0A0000C8}, {0xC0A80000, 0xC0A8FFFF}, {0xAC100504, 0xAC100504},
+            {0, upper_limit}, {upper_limit, upper_limit}, {0x01020304, 0x01020304}
+        });
+        for (const auto parser : parsers)
+        {
+            ASSERT_EQ(expected, parse_pool_text(text, parser));
+            ASSERT_EQ(FlatPool(), parse_pool_text("", parser));
+            ASSERT_EQ(FlatPool(), parse_pool_text("\n\r\n\n", parser));
+            ASSERT_EQ(FlatPool(std::vector<Range>{{1, 1}}), parse_pool_text("0.0.0.1\r\n", parser));
+            ASSERT_EQ(FlatPool(std::vector<Range>{{0x0A000000, 0x0A000001}}), parse_pool_text("010.000.00.0/31\n", parser));
+        }
+    }
+
+
+    TEST(TestPoolText, TestErrors)
+    {
+        const std::vector<std::string> wrong_lines{
+            "1.2.3", "1.2.3.4.5", "1.2.3.4.", "1.2.3.256", "1.2.3.4567", "1..3.4", ".1.2.3.4", "1.2.3.-4",
+            "a.b.c.d", " 1.2.3.4", "1.2.3.4 ", "1.2.3.4-", "1.2.3.4-1.2.3", "1.2.3.4-1.2.3.3", "1.2.3.4/",
+            "1.2.3.4/33", "1.2.3.4/24", "1.2.3.0/024", "1.2.3.4/+3", "1.2.3.4\r\r\n", "1.2.3.4,1.2.3.5", "\r "
+        };
+        for (const auto parser : parsers)
+        {
+            for (const auto& line : wrong_lines)
+            {
+                // Both at the end of text (scalar parser) and before long lines (SSSE3 parser)
+                ASSERT_EQ(3, errorLine("1.1.1.1\n\n" + line, parser)) << line;
+                ASSERT_EQ(3, errorLine("1.1.1.1\n\n" + line + "\n100.100.100.100-100.100.100.200\n", parser)) << line;
+            }
+        }
+    }
+
+
+    TEST(TestPoolText, TestLoadFile)
+    {
+        const auto path = std::filesystem::temp_directory_path() / "netup_tt_pool_text_test.txt";
+        {
+            std::ofstream file(path, std::ios::binary);
+            file << "10.0.0.0/8\n11.0.0.0-11.0.0.10\n10.1.1.1\n";
+        }
+        const FlatPool pool = load_pool_text(path);
+        std::filesystem::remove(path);
+        ASSERT_EQ(FlatPool(std::vector<Range>{{0x0A000000, 0x0AFFFFFF}, {0x0A010101, 0x0A010101}, {0x0B000000, 0x0B00000A}}), pool);
+        ASSERT_FALSE(pool.is_reduced());
+
+        ASSERT_THROW(load_pool_text(path), std::system_error);
+    }
+
+
+    TEST(TestPoolText, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348};
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            const Pool pool = makeRandomPool(gen, upper_limit, 100'000, 3'000);
+
+            // Every form of lines, prefixes made from the same ranges
+            std::string text;
+            std::vector<Cidr> cidrs;
+            for (const auto& [first, last] : pool)
+            {
+                if (gen() % 4 == 0)
+                {
+                    for_each_cidr(Range{first, last}, [&text](const Cidr& cidr)
+                    {
+                        text += formatAddress(cidr.address) + '/' + std::to_string(cidr.prefix_length) + '\n';
+                    });
+                }
+                else if (first == last)
+                {
+                    text += formatAddress(first) + '\n';
+                }
+                else
+                {
+                    text += formatAddress(first) + '-' + formatAddress(last) + (gen() % 2 == 0 ? "\n" : "\r\n");
+                }
+            }
+
+            for (const auto parser : parsers)
+            {
+                ASSERT_EQ(find_diff(pool, Pool{}), find_diff(parse_pool_text(text, parser).to_pool(), Pool{}));
+            }
+            ASSERT_EQ(parse_pool_text(text, AddressParser::scalar), parse_pool_text(text, AddressParser::ssse3));
+        }
+    }
+
+} // anonymous namespace
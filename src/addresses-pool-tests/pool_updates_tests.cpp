@@ -0,0 +1,110 @@
+#include <cstddef>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "pool_updates.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+    constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+
+
+    Pool reduce(const Pool& pool)
+    {
+        return find_diff(pool, Pool{});
+    }
+
+
+    Pool unite(Pool pool, const Pool& other)
+    {
+        pool.insert(other.cbegin(), other.cend());
+        return reduce(pool);
+    }
+
+
+    TEST(TestPoolUpdates, TestSubtract)
+    {
+        Pool pool{{0, 10}, {20, 30}, {40, 50}, {60, 70}, {upper_limit - 5, upper_limit}};
+        const Range* const cut_node = &*pool.find(Range{40, 50});
+
+        subtract_in_place(pool, Pool{{5, 22}, {25, 26}, {45, 45}, {45, 47}, {65, 80}, {upper_limit, upper_limit}});
+        ASSERT_EQ((Pool{{0, 4}, {23, 24}, {27, 30}, {40, 44}, {48, 50}, {60, 64}, {upper_limit - 5, upper_limit - 1}}), pool);
+        // Cut range keeps its node
+        ASSERT_EQ(cut_node, &*pool.find(Range{40, 44}));
+
+        subtract_in_place(pool, Pool{{0, upper_limit}});
+        ASSERT_TRUE(pool.empty());
+        subtract_in_place(pool, Pool{{1, 2}});
+        ASSERT_TRUE(pool.empty());
+    }
+
+
+    TEST(TestPoolUpdates, TestAdd)
+    {
+        Pool pool{{10, 20}, {30, 40}, {50, 60}, {upper_limit - 5, upper_limit - 1}};
+        const Range* const merged_node = &*pool.find(Range{30, 40});
+
+        add_in_place(pool, Pool{{0, 5}, {25, 29}, {27, 45}, {61, 61}, {upper_limit, upper_limit}});
+        ASSERT_EQ((Pool{{0, 5}, {10, 20}, {25, 45}, {50, 61}, {upper_limit - 5, upper_limit}}), pool);
+        // Merged range reuses the node of the range it has been merged with
+        ASSERT_EQ(merged_node, &*pool.find(Range{25, 45}));
+
+        add_in_place(pool, Pool{{6, 9}, {21, 24}});
+        ASSERT_EQ((Pool{{0, 45}, {50, 61}, {upper_limit - 5, upper_limit}}), pool);
+
+        add_in_place(pool, Pool{{0, upper_limit}});
+        ASSERT_EQ((Pool{{0, upper_limit}}), pool);
+    }
+
+
+    TEST(TestPoolUpdates, TestNormalizedPool)
+    {
+        NormalizedPool pool(Pool{{0, 10}, {20, 30}, {40, 50}});
+        subtract_in_place(pool, Pool{{5, 5}, {25, 45}});
+        ASSERT_EQ((Pool{{0, 4}, {6, 10}, {20, 24}, {46, 50}}), pool.to_pool());
+        add_in_place(pool, Pool{{5, 5}, {11, 19}, {upper_limit, upper_limit}});
+        ASSERT_EQ((Pool{{0, 24}, {46, 50}, {upper_limit, upper_limit}}), pool.to_pool());
+
+        pool.erase(Range{0, upper_limit});
+        ASSERT_TRUE(pool.empty());
+    }
+
+
+    TEST(TestPoolUpdates, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348};
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            Pool pool = reduce(makeRandomPool(gen, 1'000'000, 1'000, 2'000));
+            NormalizedPool normalized_pool(pool);
+            for (std::size_t step = 0; step < 50; ++step)
+            {
+                const Pool update = makeRandomPool(gen, 1'000'000, 3'000, step % 10 * 20);
+                const Pool expected = step % 2 == 0 ? find_diff(pool, update) : unite(pool, update);
+                if (step % 2 == 0)
+                {
+                    subtract_in_place(pool, update);
+                    subtract_in_place(normalized_pool, update);
+                }
+                else
+                {
+                    add_in_place(pool, update);
+                    add_in_place(normalized_pool, update);
+                }
+                ASSERT_EQ(expected, pool);
+                ASSERT_EQ(expected, normalized_pool.to_pool());
+            }
+        }
+    }
+
+} // anonymous namespace
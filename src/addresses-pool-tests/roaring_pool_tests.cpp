@@ -0,0 +1,157 @@
+#include <cstddef>
+#include <cstdint>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "roaring_pool.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+    using ChunkForm = RoaringPool::ChunkForm;
+
+
+    Pool reduce(const Pool& pool)
+    {
+        return find_diff(pool, Pool{});
+    }
+
+
+    // Random ranges inside chunk [base, base + 65535]
+    Pool makeChunkPool(std::mt19937& gen, const IPAddress base, const IPAddress range_max_len, const std::size_t pool_size)
+    {
+        std::uniform_int_distribution<IPAddress> range_start_distribution(base, base + 0xFFFF);
+        std::uniform_int_distribution<IPAddress> range_length_distribution(1, range_max_len);
+        return makeRandomFilledPool(range_start_distribution, range_length_distribution, gen, base + 0xFFFF, pool_size);
+    }
+
+
+    // Pool inside one chunk which is kept in the given form
+    Pool makeChunkPool(std::mt19937& gen, const ChunkForm form, const IPAddress base)
+    {
+        switch (form)
+        {
+        case ChunkForm::runs:
+            // Few long ranges
+            return makeChunkPool(gen, base, 5'000, 10);
+        case ChunkForm::array:
+            // Few single addresses
+            return makeChunkPool(gen, base, 1, 500);
+        case ChunkForm::bitmap:
+            // Lots of short ranges with holes between them
+            return makeChunkPool(gen, base, 8, 3'000);
+        }
+        return {};
+    }
+
+
+    TEST(TestRoaringPool, TestConversions)
+    {
+        constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+
+        ASSERT_TRUE(RoaringPool().empty());
+        ASSERT_TRUE(RoaringPool(Pool{}).empty());
+        ASSERT_EQ(Pool{}, RoaringPool(Pool{}).to_pool());
+
+        {
+            // Ranges which cross chunks' boundaries are split and glued back
+            const Pool pool{{0, 0}, {1, 17}, {6, 12}, {65'530, 65'540}, {0x10000 * 7 - 1, 0x10000 * 9}, {upper_limit - 70'000, upper_limit}};
+            const RoaringPool roaring_pool(pool);
+            ASSERT_EQ(reduce(pool), roaring_pool.to_pool());
+            ASSERT_EQ(1 + 17 + 11 + (0x10000 * 2 + 2) + 70'001, roaring_pool.addresses_count());
+            ASSERT_EQ(ChunkForm::runs, roaring_pool.chunk_form(7));
+            ASSERT_EQ(std::nullopt, roaring_pool.chunk_form(5));
+        }
+
+        {
+            // Whole address space
+            const RoaringPool roaring_pool(Pool{{0, upper_limit}});
+            ASSERT_EQ((Pool{{0, upper_limit}}), roaring_pool.to_pool());
+            ASSERT_EQ(std::uint64_t{upper_limit} + 1, roaring_pool.addresses_count());
+            ASSERT_EQ(65'536, roaring_pool.chunks_count());
+        }
+    }
+
+
+    TEST(TestRoaringPool, TestForms)
+    {
+        std::mt19937 gen(783423);
+        for (const auto form : {ChunkForm::runs, ChunkForm::array, ChunkForm::bitmap})
+        {
+            const Pool pool = makeChunkPool(gen, form, 0x30000);
+            const RoaringPool roaring_pool(pool);
+            ASSERT_EQ(form, roaring_pool.chunk_form(3));
+            ASSERT_EQ(1, roaring_pool.chunks_count());
+            ASSERT_EQ(reduce(pool), roaring_pool.to_pool());
+        }
+
+        {
+            // Bitmap is never bigger than 8 KiB per chunk
+            Pool pool;
+            for (IPAddress address = 0; address < 0x10000; address += 2)
+            {
+                pool.emplace(address, address);
+            }
+            const RoaringPool roaring_pool(pool);
+            ASSERT_EQ(ChunkForm::bitmap, roaring_pool.chunk_form(0));
+            ASSERT_EQ(8192 + 2, roaring_pool.bytes_used());
+        }
+    }
+
+
+    TEST(TestRoaringPool, TestDiff)
+    {
+        const Pool old_addresses{{1, 37}, {37, 89}, {80, 100}, {200, 300}, {65'000, 140'000}};
+        const Pool new_addresses{{10, 20}, {30, 40}, {50, 80}, {80, 110}, {50, 110}, {150, 180}, {190, 202}, {220, 235}, {65'536, 65'536}};
+        const RoaringPool diff = find_diff(RoaringPool(old_addresses), RoaringPool(new_addresses));
+        ASSERT_EQ(find_diff(old_addresses, new_addresses), diff.to_pool());
+        ASSERT_TRUE(find_diff(RoaringPool(old_addresses), RoaringPool(old_addresses)).empty());
+    }
+
+
+    TEST(TestRoaringPool, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348};
+        const std::vector<ChunkForm> forms{ChunkForm::runs, ChunkForm::array, ChunkForm::bitmap};
+
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            // Every pair of forms, so that every kernel is used
+            for (const auto old_form : forms)
+            {
+                for (const auto new_form : forms)
+                {
+                    Pool old_pool, new_pool;
+                    for (const IPAddress base : {0x00000u, 0x10000u, 0x50000u})
+                    {
+                        old_pool.merge(makeChunkPool(gen, old_form, base));
+                    }
+                    for (const IPAddress base : {0x10000u, 0x20000u, 0x50000u})
+                    {
+                        new_pool.merge(makeChunkPool(gen, new_form, base));
+                    }
+
+                    const RoaringPool old_roaring_pool(old_pool);
+                    const RoaringPool new_roaring_pool(new_pool);
+                    ASSERT_EQ(old_form, old_roaring_pool.chunk_form(1));
+                    ASSERT_EQ(new_form, new_roaring_pool.chunk_form(1));
+
+                    const RoaringPool diff = find_diff(old_roaring_pool, new_roaring_pool);
+                    ASSERT_EQ(find_diff(old_pool, new_pool), diff.to_pool());
+                    // Forms of the diff are chosen the same way as for a pool made from scratch
+                    ASSERT_EQ(RoaringPool(diff.to_pool()), diff);
+                }
+            }
+        }
+    }
+
+} // anonymous namespace
@@ -0,0 +1,111 @@
+#include <cstddef>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "static_pool.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+
+    constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+
+    // Everything below is checked by the compiler
+    constexpr StaticPool reserved(std::to_array<Range>({
+        {0x7f000000, 0x7fffffff},       // 127.0.0.0/8
+        {0x0a000000, 0x0affffff},       // 10.0.0.0/8
+        {0xc0a80000, 0xc0a8ffff},       // 192.168.0.0/16
+        {0x00000000, 0x00ffffff},       // 0.0.0.0/8
+        {0xac100000, 0xac1fffff},       // 172.16.0.0/12
+        {0x0a800000, 0x0a8fffff},       // 10.128.0.0/12, inside 10.0.0.0/8
+        {0x01000000, 0x01000000}        // adjacent to 0.0.0.0/8
+    }));
+    static_assert(reserved.size() == 5);
+    static_assert(reserved.ranges()[0] == Range{0x00000000, 0x01000000});
+    static_assert(reserved.contains(0x0a800001) && reserved.contains(0xac1fffff));
+    static_assert(!reserved.contains(0x08080808) && !reserved.contains(0xac200000));
+
+    constexpr StaticPool exceptions(std::to_array<Range>({
+        {0x0a000000, 0x0a0000ff},       // 10.0.0.0/24
+        {0x7f000001, 0x7f000001}        // 127.0.0.1
+    }));
+    constexpr auto blocked = find_diff(reserved, exceptions);
+    static_assert(blocked.size() == 6);
+    static_assert(!blocked.contains(0x0a000010) && blocked.contains(0x0a000100));
+    static_assert(!blocked.contains(0x7f000001) && blocked.contains(0x7f000002) && blocked.contains(0x7f000000));
+
+    constexpr auto trimmed = blocked.with_capacity<blocked.size()>();
+    static_assert(sizeof(trimmed) < sizeof(blocked));
+    static_assert(trimmed == blocked);
+
+
+    TEST(TestStaticPool, TestConstruction)
+    {
+        constexpr StaticPool pool(std::to_array<Range>({{20, 30}, {0, 9}, {5, 12}, {31, 31}, {upper_limit, upper_limit}}));
+        ASSERT_EQ((Pool{{0, 12}, {20, 31}, {upper_limit, upper_limit}}), pool.to_pool());
+        ASSERT_TRUE(pool.contains(upper_limit));
+        ASSERT_FALSE(pool.contains(upper_limit - 1));
+
+        ASSERT_TRUE(StaticPool<4>().empty());
+        ASSERT_FALSE(StaticPool<4>().contains(0));
+        ASSERT_EQ(pool, pool.with_capacity<3>());
+        ASSERT_THROW(pool.with_capacity<2>(), std::invalid_argument);
+    }
+
+
+    TEST(TestStaticPool, TestFindDiff)
+    {
+        constexpr StaticPool old_pool(std::to_array<Range>({{0, 9}, {20, 30}, {40, 50}, {upper_limit - 1, upper_limit}}));
+        constexpr StaticPool new_pool(std::to_array<Range>({{2, 3}, {10, 25}, {40, 50}, {upper_limit, upper_limit}}));
+        constexpr auto diff = find_diff(old_pool, new_pool);
+
+        ASSERT_EQ((Pool{{0, 1}, {4, 9}, {26, 30}, {upper_limit - 1, upper_limit - 1}}), diff.to_pool());
+        ASSERT_TRUE(find_diff(new_pool, new_pool).empty());
+        ASSERT_EQ(old_pool, find_diff(old_pool, StaticPool<0>()));
+    }
+
+
+    TEST(TestStaticPool, PerformRandomizedTests)
+    {
+        constexpr std::size_t pool_size = 64;
+        const auto make_ranges = [](std::mt19937& gen)
+        {
+            std::uniform_int_distribution<IPAddress> first_distribution(0, 10'000);
+            std::uniform_int_distribution<IPAddress> length_distribution(0, 300);
+            std::array<Range, pool_size> ranges;
+            std::generate(ranges.begin(), ranges.end(), [&]
+            {
+                const IPAddress first = first_distribution(gen);
+                return Range{first, first + length_distribution(gen)};
+            });
+            return ranges;
+        };
+
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348};
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            for (std::size_t step = 0; step < 100; ++step)
+            {
+                const auto old_ranges = make_ranges(gen);
+                const auto new_ranges = make_ranges(gen);
+                const StaticPool old_pool(old_ranges);
+                const StaticPool new_pool(new_ranges);
+
+                ASSERT_EQ(
+                    find_diff(Pool(old_ranges.cbegin(), old_ranges.cend()), Pool(new_ranges.cbegin(), new_ranges.cend())),
+                    find_diff(old_pool, new_pool).to_pool()
+                );
+            }
+        }
+    }
+
+} // anonymous namespace
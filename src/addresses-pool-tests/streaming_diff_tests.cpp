@@ -0,0 +1,124 @@
+#include <cstddef>
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "flat_pool.h"
+#include "ipv4_pools.h"
+#include "test_helpers.h"
+
+
+namespace
+{
+    using namespace netup_tt;
+    using namespace netup_tt::tests;
+
+
+    TEST(TestStreamingDiff, TestSink)
+    {
+        const Pool old_addresses{{1, 37}, {40, 76}, {80, 100}, {200, 300}};
+        const Pool new_addresses{{10, 20}, {44, 57}, {85, 99}, {233, 287}};
+        const std::vector<Range> what_result_should_be{
+            {1, 9}, {21, 37},
+            {40, 43}, {58, 76},
+            {80, 84}, {100, 100},
+            {200, 232}, {288, 300}
+        };
+
+        {
+            std::vector<Range> result;
+            find_diff(old_addresses, new_addresses, [&result](const Range& range) { result.push_back(range); });
+            ASSERT_EQ(what_result_should_be, result);
+        }
+
+        {
+            std::vector<Range> result;
+            find_diff(
+                FlatPool(old_addresses),
+                FlatPool(new_addresses),
+                [&result](const Range& range) { result.push_back(range); }
+            );
+            ASSERT_EQ(what_result_should_be, result);
+        }
+
+        {
+            // Sink is allowed to be a stateful function object which is modified by calls
+            struct AddressesCounter
+            {
+                std::size_t count = 0;
+                void operator()(const Range& range) { count += range.second - range.first + 1; }
+            };
+            AddressesCounter counter;
+            find_diff(old_addresses, new_addresses, counter);
+            ASSERT_EQ(9 + 17 + 4 + 19 + 5 + 1 + 33 + 13, counter.count);
+        }
+    }
+
+
+    TEST(TestStreamingDiff, TestOutputIterator)
+    {
+        const Pool old_addresses{{0, 1400}};
+        const Pool new_addresses{{147, 193}, {1, 17}, {146, 146}, {2, 145}, {233, 233}, {240, 248}, {261, 303}};
+        const std::vector<Range> what_result_should_be{
+            {0, 0}, {194, 232}, {234, 239}, {249, 260}, {304, 1400}
+        };
+
+        {
+            std::vector<Range> result;
+            find_diff(old_addresses, new_addresses, std::back_inserter(result));
+            ASSERT_EQ(what_result_should_be, result);
+        }
+
+        {
+            // Plain preallocated array, returned iterator points past the last written range
+            std::array<Range, 10> result{};
+            const auto result_end = find_diff(old_addresses, new_addresses, result.begin());
+            ASSERT_EQ(what_result_should_be.size(), static_cast<std::size_t>(result_end - result.begin()));
+            ASSERT_TRUE(std::equal(result.begin(), result_end, what_result_should_be.cbegin()));
+        }
+
+        {
+            Pool result;
+            find_diff(FlatPool(old_addresses), FlatPool(new_addresses), std::inserter(result, result.end()));
+            ASSERT_EQ(find_diff(old_addresses, new_addresses), result);
+        }
+    }
+
+
+    TEST(TestStreamingDiff, TestNothingIsEmitted)
+    {
+        std::size_t calls_count = 0;
+        const auto counting_sink = [&calls_count](const Range&) { ++calls_count; };
+
+        find_diff(Pool{}, Pool{}, counting_sink);
+        find_diff(Pool{}, Pool{{1, 145}, {147, 986}}, counting_sink);
+        find_diff(Pool{{3, 5}, {7, 12}, {14, 20}}, Pool{{3, 20}}, counting_sink);
+        ASSERT_EQ(0, calls_count);
+    }
+
+
+    TEST(TestStreamingDiff, PerformRandomizedTests)
+    {
+        const std::vector<std::size_t> seeds{9055234, 783423, 112348, 8682340, 2096436};
+
+        for (const auto seed : seeds)
+        {
+            std::mt19937 gen(seed);
+            const Pool old_pool = makeRandomPool(gen, 10'000, 100, 2000);
+            const Pool new_pool = makeRandomPool(gen, 10'000, 100, 1000);
+            const Pool what_result_should_be = find_diff(old_pool, new_pool);
+
+            std::vector<Range> result;
+            find_diff(old_pool, new_pool, std::back_inserter(result));
+            ASSERT_EQ(what_result_should_be, Pool(result.cbegin(), result.cend()));
+            // Ranges go in ascending order
+            ASSERT_TRUE(std::equal(result.cbegin(), result.cend(), what_result_should_be.cbegin()));
+        }
+    }
+
+} // anonymous namespace
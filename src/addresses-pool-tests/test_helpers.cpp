@@ -0,0 +1,49 @@
+#include "test_helpers.h"
+
+#include <algorithm>
+
+
+namespace netup_tt::tests
+{
+
+    Pool makeRandomFilledPool(
+        std::uniform_int_distribution<IPAddress>& range_start_distribution, 
+        std::uniform_int_distribution<IPAddress>& range_length_distribution, 
+        std::mt19937& generator, 
+        const IPAddress range_last_max, 
+        const std::size_t pool_size
+    )
+    {
+        Pool pool;
+        while (pool.size() < pool_size)
+        {
+            const auto range_start = range_start_distribution(generator);
+            const auto range_length = std::min(
+                range_last_max - range_start + 1, 
+                range_length_distribution(generator)
+            );
+            pool.emplace(range_start, range_start + range_length - 1);
+        }
+        return pool;
+    }
+
+
+    Pool makeRandomPool(
+        std::mt19937& generator, 
+        const IPAddress mask_size, 
+        const IPAddress range_max_len, 
+        const std::size_t pool_size
+    )
+    {
+        std::uniform_int_distribution<IPAddress> range_start_distribution(0, mask_size - 1);
+        std::uniform_int_distribution<IPAddress> range_length_distribution(1, range_max_len);
+        return makeRandomFilledPool(
+            range_start_distribution, 
+            range_length_distribution, 
+            generator, 
+            mask_size - 1, 
+            pool_size
+        );
+    }
+
+} // namespace netup_tt::tests
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+
+#include <random>
+
+#include "ipv4_pools.h"
+
+
+namespace netup_tt::tests
+{
+
+    Pool makeRandomFilledPool(
+        std::uniform_int_distribution<IPAddress>& range_start_distribution, 
+        std::uniform_int_distribution<IPAddress>& range_length_distribution, 
+        std::mt19937& generator, 
+        const IPAddress range_last_max, 
+        const std::size_t pool_size
+    );
+
+    // Shortcut for `makeRandomFilledPool`: ranges start in [0, mask_size) 
+    // and their lengths are in [1, range_max_len]
+    Pool makeRandomPool(
+        std::mt19937& generator, 
+        const IPAddress mask_size, 
+        const IPAddress range_max_len, 
+        const std::size_t pool_size
+    );
+
+} // namespace netup_tt::tests
@@ -0,0 +1,400 @@
+#include "address_allocator.h"
+
+#include <cassert>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "pool_diff_impl.h"
+
+
+namespace netup_tt
+{
+
+    namespace detail
+    {
+
+        struct FreeRangeNode
+        {
+            Range range;
+            // The longest range of the subtree
+            std::uint64_t max_length{0};
+            // Treap is a heap by priorities (they are random, so it's balanced on average)
+            std::uint32_t priority{0};
+            std::unique_ptr<FreeRangeNode> left;
+            std::unique_ptr<FreeRangeNode> right;
+        };
+
+    } // namespace detail
+
+
+    namespace
+    {
+
+        using Node = detail::FreeRangeNode;
+        using NodePtr = std::unique_ptr<Node>;
+
+
+        std::uint64_t rangeLength(const Range& range)
+        {
+            return std::uint64_t{range.second} - range.first + 1;
+        }
+
+
+        std::uint64_t maxLength(const NodePtr& node)
+        {
+            return node ? node->max_length : 0;
+        }
+
+
+        void updateMaxLength(Node& node)
+        {
+            node.max_length = std::max({rangeLength(node.range), maxLength(node.left), maxLength(node.right)});
+        }
+
+
+        // Splits the treap into ranges which start before `first` and the others
+        std::pair<NodePtr, NodePtr> split(NodePtr node, const IPAddress first)
+        {
+            if (!node)
+            {
+                return {};
+            }
+            if (node->range.first < first)
+            {
+                auto [left, right] = split(std::move(node->right), first);
+                node->right = std::move(left);
+                updateMaxLength(*node);
+                return {std::move(node), std::move(right)};
+            }
+            auto [left, right] = split(std::move(node->left), first);
+            node->left = std::move(right);
+            updateMaxLength(*node);
+            return {std::move(left), std::move(node)};
+        }
+
+
+        // All ranges of `left` should be before ranges of `right`
+        NodePtr merge(NodePtr left, NodePtr right)
+        {
+            if (!left)
+            {
+                return right;
+            }
+            if (!right)
+            {
+                return left;
+            }
+            if (left->priority > right->priority)
+            {
+                left->right = merge(std::move(left->right), std::move(right));
+                updateMaxLength(*left);
+                return left;
+            }
+            right->left = merge(std::move(left), std::move(right->left));
+            updateMaxLength(*right);
+            return right;
+        }
+
+
+        void insertNode(NodePtr& root, NodePtr node)
+        {
+            if (!root)
+            {
+                root = std::move(node);
+                return;
+            }
+            if (node->priority > root->priority)
+            {
+                auto [left, right] = split(std::move(root), node->range.first);
+                node->left = std::move(left);
+                node->right = std::move(right);
+                updateMaxLength(*node);
+                root = std::move(node);
+                return;
+            }
+            NodePtr& child = node->range.first < root->range.first ? root->left : root->right;
+            insertNode(child, std::move(node));
+            updateMaxLength(*root);
+        }
+
+
+        void eraseNode(NodePtr& root, const IPAddress first)
+        {
+            assert(root);
+            if (root->range.first == first)
+            {
+                root = merge(std::move(root->left), std::move(root->right));
+                return;
+            }
+            eraseNode(first < root->range.first ? root->left : root->right, first);
+            updateMaxLength(*root);
+        }
+
+
+        // The last range which starts at `address` or before it
+        const Node* findFloor(const Node* node, const IPAddress address)
+        {
+            const Node* found = nullptr;
+            while (node != nullptr)
+            {
+                if (node->range.first <= address)
+                {
+                    found = node;
+                    node = node->right.get();
+                }
+                else
+                {
+                    node = node->left.get();
+                }
+            }
+            return found;
+        }
+
+
+        // In-order search which skips subtrees without ranges of `min_length` addresses.
+        // When `fits` accepts every long enough range, it's a single descent.
+        template <typename Fits>
+        std::optional<std::pair<Range, Range>> findFirstBlock(const Node* const node, const std::uint64_t min_length, Fits& fits)
+        {
+            if (node == nullptr || node->max_length < min_length)
+            {
+                return std::nullopt;
+            }
+            if (auto found = findFirstBlock(node->left.get(), min_length, fits))
+            {
+                return found;
+            }
+            if (rangeLength(node->range) >= min_length)
+            {
+                if (const auto block = fits(node->range))
+                {
+                    return std::pair{node->range, *block};
+                }
+            }
+            return findFirstBlock(node->right.get(), min_length, fits);
+        }
+
+
+        void collectRanges(const Node* const node, Pool& pool)
+        {
+            if (node == nullptr)
+            {
+                return;
+            }
+            collectRanges(node->left.get(), pool);
+            pool.emplace_hint(pool.cend(), node->range);
+            collectRanges(node->right.get(), pool);
+        }
+
+
+        void checkRange(const Range& range)
+        {
+            if (range.first > range.second)
+            {
+                throw std::invalid_argument("Range ends before it starts");
+            }
+        }
+
+    } // anonymous namespace
+
+
+    AddressAllocator::AddressAllocator() = default;
+
+
+    AddressAllocator::AddressAllocator(const Pool& capacity)
+    {
+        detail::ReducedRangesReader next_range(capacity.cbegin(), capacity.cend());
+        while (const auto range = next_range())
+        {
+            addFree(*range);
+        }
+    }
+
+
+    AddressAllocator::AddressAllocator(const Pool& capacity, const Pool& allocated)
+    {
+        find_diff(capacity, allocated, [this](const Range& range) { addFree(range); });
+    }
+
+
+    AddressAllocator::~AddressAllocator() = default;
+    AddressAllocator::AddressAllocator(AddressAllocator&&) noexcept = default;
+    AddressAllocator& AddressAllocator::operator=(AddressAllocator&&) noexcept = default;
+
+
+    template <typename Fits>
+    std::optional<std::pair<Range, Range>> AddressAllocator::findBlock(const std::uint64_t min_length, const Fit fit, Fits&& fits) const
+    {
+        if (fit == Fit::first)
+        {
+            return findFirstBlock(root_.get(), min_length, fits);
+        }
+        for (auto iter = by_length_.lower_bound({min_length, 0}); iter != by_length_.end(); ++iter)
+        {
+            const auto [length, first] = *iter;
+            const Range range{first, static_cast<IPAddress>(first + length - 1)};
+            if (const auto block = fits(range))
+            {
+                return std::pair{range, *block};
+            }
+        }
+        return std::nullopt;
+    }
+
+
+    std::optional<IPAddress> AddressAllocator::allocate(const Fit fit)
+    {
+        const auto block = allocate_block(1, fit);
+        return block ? std::optional(block->first) : std::nullopt;
+    }
+
+
+    std::optional<Range> AddressAllocator::allocate_block(const std::uint64_t size, const Fit fit)
+    {
+        if (size == 0)
+        {
+            throw std::invalid_argument("Block size should be more than 0");
+        }
+        const auto found = findBlock(size, fit, [size](const Range& range)
+        {
+            return std::optional(Range{range.first, static_cast<IPAddress>(range.first + size - 1)});
+        });
+        if (!found)
+        {
+            return std::nullopt;
+        }
+        take(found->first, found->second);
+        return found->second;
+    }
+
+
+    std::optional<Cidr> AddressAllocator::allocate_prefix(const std::uint8_t prefix_length, const Fit fit)
+    {
+        if (prefix_length > 32)
+        {
+            throw std::invalid_argument("Invalid prefix length: " + std::to_string(prefix_length));
+        }
+        const std::uint64_t size = std::uint64_t{1} << (32 - prefix_length);
+        const auto found = findBlock(size, fit, [size](const Range& range) -> std::optional<Range>
+        {
+            const std::uint64_t first = (std::uint64_t{range.first} + size - 1) & ~(size - 1);
+            if (first + size - 1 > range.second)
+            {
+                return std::nullopt;
+            }
+            return Range{static_cast<IPAddress>(first), static_cast<IPAddress>(first + size - 1)};
+        });
+        if (!found)
+        {
+            return std::nullopt;
+        }
+        take(found->first, found->second);
+        return Cidr{found->second.first, prefix_length};
+    }
+
+
+    void AddressAllocator::release(const Range& range)
+    {
+        checkRange(range);
+        // Free ranges are reduced, so only the last one starting before the end of `range` may intersect it
+        if (const Node* const node = findFloor(root_.get(), range.second); node != nullptr && node->range.second >= range.first)
+        {
+            throw std::invalid_argument("Released addresses are free already");
+        }
+
+        Range merged = range;
+        if (range.first > 0)
+        {
+            if (const Node* const previous = findFloor(root_.get(), range.first - 1); previous != nullptr && previous->range.second == range.first - 1)
+            {
+                merged.first = previous->range.first;
+                removeFree(Range{previous->range});
+            }
+        }
+        if (range.second < std::numeric_limits<IPAddress>::max())
+        {
+            if (const Node* const next = findFloor(root_.get(), range.second + 1); next != nullptr && next->range.first == range.second + 1)
+            {
+                merged.second = next->range.second;
+                removeFree(Range{next->range});
+            }
+        }
+        addFree(merged);
+    }
+
+
+    bool AddressAllocator::reserve(const Range& range)
+    {
+        checkRange(range);
+        const Node* const node = findFloor(root_.get(), range.first);
+        if (node == nullptr || node->range.second < range.second)
+        {
+            return false;
+        }
+        take(Range{node->range}, range);
+        return true;
+    }
+
+
+    bool AddressAllocator::is_free(const IPAddress address) const
+    {
+        const Node* const node = findFloor(root_.get(), address);
+        return node != nullptr && node->range.second >= address;
+    }
+
+
+    Pool AddressAllocator::free_pool() const
+    {
+        Pool pool;
+        collectRanges(root_.get(), pool);
+        return pool;
+    }
+
+
+    void AddressAllocator::addFree(const Range& range)
+    {
+        auto node = std::make_unique<Node>();
+        node->range = range;
+        node->max_length = rangeLength(range);
+        node->priority = nextPriority();
+        insertNode(root_, std::move(node));
+        by_length_.emplace(rangeLength(range), range.first);
+        free_addresses_count_ += rangeLength(range);
+    }
+
+
+    void AddressAllocator::removeFree(const Range& range)
+    {
+        eraseNode(root_, range.first);
+        by_length_.erase({rangeLength(range), range.first});
+        free_addresses_count_ -= rangeLength(range);
+    }
+
+
+    void AddressAllocator::take(const Range& range, const Range& block)
+    {
+        removeFree(range);
+        if (range.first < block.first)
+        {
+            addFree(Range{range.first, block.first - 1});
+        }
+        if (block.second < range.second)
+        {
+            addFree(Range{block.second + 1, range.second});
+        }
+    }
+
+
+    std::uint32_t AddressAllocator::nextPriority() noexcept
+    {
+        // xorshift32
+        random_state_ ^= random_state_ << 13;
+        random_state_ ^= random_state_ >> 17;
+        random_state_ ^= random_state_ << 5;
+        return random_state_;
+    }
+
+} // namespace netup_tt
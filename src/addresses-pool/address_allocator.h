@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <memory>
+#include <optional>
+#include <set>
+#include <utility>
+
+#include "cidr.h"
+#include "ipv4_pools.h"
+
+
+namespace netup_tt
+{
+
+    namespace detail
+    {
+
+        // Node of the treap of free ranges, it's defined in the source file
+        struct FreeRangeNode;
+
+    } // namespace detail
+
+
+    // Assigns addresses from a pool of free ones: single addresses, contiguous blocks and aligned prefixes.
+    // Free addresses are kept as reduced ranges in two indexes:
+    //
+    //     by address   treap ordered by starts of ranges, every node also knows the longest range
+    //                  of its subtree, so the first range (by address) of at least N addresses
+    //                  is found by one descent, skipping subtrees without long enough ranges
+    //     by length    `std::set` of (length, start), so the shortest range of at least N addresses
+    //                  is one `lower_bound`
+    //
+    // So allocation with both first fit and best fit, release and reserve cost O(log n)
+    // for n free ranges. Prefixes are an exception: a range of at least 2^k addresses
+    // may still have no aligned block of 2^k addresses in it, such ranges are skipped
+    // (every range of at least 2 * 2^k - 1 addresses has one).
+    class AddressAllocator
+    {
+    public:
+        enum class Fit
+        {
+            // Free range with the lowest addresses, allocations are packed at the start of the space
+            first,
+            // The shortest free range which fits, long ranges are kept for big blocks
+            best
+        };
+
+        AddressAllocator();
+        // All addresses of `capacity` are free
+        explicit AddressAllocator(const Pool& capacity);
+        // Addresses of `capacity` which aren't in `allocated` are free
+        AddressAllocator(const Pool& capacity, const Pool& allocated);
+        ~AddressAllocator();
+
+        AddressAllocator(AddressAllocator&&) noexcept;
+        AddressAllocator& operator=(AddressAllocator&&) noexcept;
+
+        // Nothing is returned if there isn't enough free addresses
+        std::optional<IPAddress> allocate(Fit fit = Fit::first);
+        // Contiguous block of `size` addresses (which should be more than 0)
+        std::optional<Range> allocate_block(std::uint64_t size, Fit fit = Fit::first);
+        // Block of addresses of a prefix, i.e. aligned to its size
+        std::optional<Cidr> allocate_prefix(std::uint8_t prefix_length, Fit fit = Fit::first);
+
+        // Makes allocated addresses free again. Throws `std::invalid_argument`
+        // if some of them are free already (nothing is changed then).
+        void release(const Range& range);
+        // Takes particular addresses (e.g. a static assignment). Returns false
+        // if some of them aren't free (nothing is changed then).
+        bool reserve(const Range& range);
+
+        bool is_free(IPAddress address) const;
+        // Reduced ranges of free addresses
+        Pool free_pool() const;
+        std::uint64_t free_addresses_count() const noexcept { return free_addresses_count_; }
+        std::size_t free_ranges_count() const noexcept { return by_length_.size(); }
+
+    private:
+        // The first (by address) or the shortest free range of at least `min_length` addresses
+        // for which `fits` gives a block, returns the range and the block
+        template <typename Fits>
+        std::optional<std::pair<Range, Range>> findBlock(std::uint64_t min_length, Fit fit, Fits&& fits) const;
+
+        void addFree(const Range& range);
+        void removeFree(const Range& range);
+        // Takes `block` out of the free range which contains it, its other parts stay free
+        void take(const Range& range, const Range& block);
+
+        std::uint32_t nextPriority() noexcept;
+
+        std::unique_ptr<detail::FreeRangeNode> root_;
+        // (length, first) of every free range
+        std::set<std::pair<std::uint64_t, IPAddress>> by_length_;
+        std::uint64_t free_addresses_count_{0};
+        // State of the generator of treap priorities
+        std::uint32_t random_state_{2463534242};
+    };
+
+} // namespace netup_tt
@@ -0,0 +1,60 @@
+#include "batch_diff.h"
+
+#include "work_stealing_executor.h"
+
+
+namespace netup_tt
+{
+
+    namespace
+    {
+
+        template <typename NewPool>
+        std::vector<NormalizedPool> findDiffs(
+            const NormalizedPool& old_pool,
+            const std::span<const NewPool> new_pools,
+            const BatchDiffOptions& options
+        )
+        {
+            std::vector<NormalizedPool> diffs(new_pools.size());
+            const ParallelExecutor& execute = options.executor ? options.executor : make_work_stealing_executor();
+            execute(new_pools.size(), [&](const std::size_t index)
+            {
+                diffs[index] = find_diff(old_pool, new_pools[index]);
+            });
+            return diffs;
+        }
+
+    } // anonymous namespace
+
+
+    std::vector<NormalizedPool> find_diffs(
+        const Pool& old_pool,
+        const std::span<const Pool> new_pools,
+        const BatchDiffOptions& options
+    )
+    {
+        return findDiffs(NormalizedPool(old_pool), new_pools, options);
+    }
+
+
+    std::vector<NormalizedPool> find_diffs(
+        const NormalizedPool& old_pool,
+        const std::span<const Pool> new_pools,
+        const BatchDiffOptions& options
+    )
+    {
+        return findDiffs(old_pool, new_pools, options);
+    }
+
+
+    std::vector<NormalizedPool> find_diffs(
+        const NormalizedPool& old_pool,
+        const std::span<const FlatPool> new_pools,
+        const BatchDiffOptions& options
+    )
+    {
+        return findDiffs(old_pool, new_pools, options);
+    }
+
+} // namespace netup_tt
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "flat_pool.h"
+#include "ipv4_pools.h"
+#include "normalized_pool.h"
+#include "parallel_diff.h"
+
+
+namespace netup_tt
+{
+
+    struct BatchDiffOptions
+    {
+        // Runs diffs with new pools, one task per pool.
+        // Empty executor means `make_work_stealing_executor()` (see "work_stealing_executor.h")
+        ParallelExecutor executor;
+    };
+
+
+    // Diffs of one old pool (like the global allocation) with every one of `new_pools`
+    // (like per-tenant pools): `result[i]` has the same ranges as `find_diff(old_pool, new_pools[i])`.
+    // The old pool is normalized once and shared read-only by all workers. Diff with a new pool
+    // much smaller than the old one gallops over the old pool, so it doesn't walk over it in full.
+    std::vector<NormalizedPool> find_diffs(
+        const Pool& old_pool,
+        std::span<const Pool> new_pools,
+        const BatchDiffOptions& options = {}
+    );
+
+    // Same as above for an old pool which is normalized already
+    std::vector<NormalizedPool> find_diffs(
+        const NormalizedPool& old_pool,
+        std::span<const Pool> new_pools,
+        const BatchDiffOptions& options = {}
+    );
+    std::vector<NormalizedPool> find_diffs(
+        const NormalizedPool& old_pool,
+        std::span<const FlatPool> new_pools,
+        const BatchDiffOptions& options = {}
+    );
+
+} // namespace netup_tt
@@ -0,0 +1,44 @@
+#include "cidr.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+
+namespace netup_tt
+{
+
+    std::vector<Cidr> to_cidrs(const Pool& pool)
+    {
+        std::vector<Cidr> cidrs;
+        find_diff(pool, Pool{}, make_cidr_sink([&cidrs](const Cidr& cidr) { cidrs.push_back(cidr); }));
+        return cidrs;
+    }
+
+
+    Pool from_cidrs(const std::span<const Cidr> cidrs)
+    {
+        std::vector<Range> ranges;
+        ranges.reserve(cidrs.size());
+        for (const auto& cidr : cidrs)
+        {
+            if (!cidr.is_valid())
+            {
+                throw std::invalid_argument(
+                    "Invalid prefix: " + std::to_string(cidr.address) + "/" + std::to_string(cidr.prefix_length)
+                );
+            }
+            ranges.push_back(cidr.to_range());
+        }
+        std::sort(ranges.begin(), ranges.end());
+
+        Pool pool;
+        detail::ReducedRangesReader next_range(ranges.cbegin(), ranges.cend());
+        while (const auto range = next_range())
+        {
+            pool.emplace_hint(pool.cend(), *range);
+        }
+        return pool;
+    }
+
+} // namespace netup_tt
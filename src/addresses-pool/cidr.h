@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <concepts>
+#include <functional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "ipv4_pools.h"
+
+
+namespace netup_tt
+{
+
+    // Network prefix like 10.0.0.0/8: all addresses whose first `prefix_length` bits match `address`.
+    // Bits of `address` after the prefix are zeros.
+    struct Cidr
+    {
+        IPAddress address{0};
+        std::uint8_t prefix_length{32};
+
+        Range to_range() const noexcept
+        {
+            const std::uint64_t size = std::uint64_t{1} << (32 - prefix_length);
+            return {address, static_cast<IPAddress>(address + size - 1)};
+        }
+
+        // Prefix isn't longer than 32 bits and bits of `address` after it are zeros
+        bool is_valid() const noexcept
+        {
+            return prefix_length <= 32 && (address & ((std::uint64_t{1} << (32 - prefix_length)) - 1)) == 0;
+        }
+
+        auto operator<=>(const Cidr&) const = default;
+    };
+
+
+    // Splits range into the minimal set of prefixes, passing them to `sink` in ascending order.
+    // Every prefix is the biggest aligned block which starts at the current address and fits into the range:
+    // its size is limited both by alignment of the address (trailing zeros) and by the rest of the range.
+    //
+    //     range     [5 ............................ 20]
+    //     prefixes  [5] [6 7] [8 ......... 15] [16 .. 19] [20]
+    //               /32  /31       /29            /30     /32
+    template <typename Sink>
+        requires std::invocable<Sink&, const Cidr&>
+    void for_each_cidr(const Range& range, Sink&& sink)
+    {
+        // 64-bit arithmetic, so that the range of the whole address space doesn't overflow
+        std::uint64_t first = range.first;
+        const std::uint64_t end = std::uint64_t{range.second} + 1;
+        while (first < end)
+        {
+            const int alignment_bits = first == 0 ? 32 : std::countr_zero(first);
+            const int fitting_bits = std::bit_width(end - first) - 1;
+            const int block_bits = std::min(alignment_bits, fitting_bits);
+            std::invoke(sink, Cidr{static_cast<IPAddress>(first), static_cast<std::uint8_t>(32 - block_bits)});
+            first += std::uint64_t{1} << block_bits;
+        }
+    }
+
+
+    // Sink for streaming `find_diff` overloads which splits every range into prefixes
+    // and passes them further. Ranges of diff are reduced, so the result is the minimal set
+    // of prefixes for the diff, and no ranges are materialized:
+    //
+    //     find_diff(old_pool, new_pool, make_cidr_sink([&](const Cidr& cidr) { ... }));
+    template <typename CidrSink>
+        requires std::invocable<CidrSink&, const Cidr&>
+    auto make_cidr_sink(CidrSink&& cidr_sink)
+    {
+        return [cidr_sink = std::forward<CidrSink>(cidr_sink)](const Range& range) mutable
+        {
+            for_each_cidr(range, cidr_sink);
+        };
+    }
+
+
+    // Minimal set of prefixes which cover the same addresses as `pool`, in ascending order
+    std::vector<Cidr> to_cidrs(const Pool& pool);
+
+    // Reduced pool of addresses covered by `cidrs` (which may go in any order and intersect).
+    // Throws `std::invalid_argument` if a prefix isn't valid (see `Cidr::is_valid`).
+    Pool from_cidrs(std::span<const Cidr> cidrs);
+
+} // namespace netup_tt
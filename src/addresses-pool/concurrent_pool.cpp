@@ -0,0 +1,156 @@
+#include "concurrent_pool.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "pool_algebra.h"
+
+
+namespace netup_tt
+{
+
+    namespace
+    {
+
+        // `(pool \ removed) ∪ added` in two linear merges, instead of shifting the ranges
+        // of `pool` for every range of the update
+        NormalizedPool applyUpdate(const NormalizedPool& pool, const Pool& removed, const Pool& added)
+        {
+            std::vector<Range> kept;
+            kept.reserve(pool.size() + removed.size());
+            find_diff(pool, removed, std::back_inserter(kept));
+            if (added.empty())
+            {
+                return NormalizedPool::from_reduced(std::move(kept));
+            }
+
+            const NormalizedPool added_pool(added);
+            using Reader = detail::PlainRangesReader<std::vector<Range>::const_iterator>;
+            detail::UnionReader next_range(std::vector<Reader>{
+                Reader(kept.cbegin(), kept.cend()),
+                Reader(added_pool.begin(), added_pool.end())
+            });
+            std::vector<Range> ranges;
+            ranges.reserve(kept.size() + added_pool.size());
+            while (const auto range = next_range())
+            {
+                ranges.push_back(*range);
+            }
+            return NormalizedPool::from_reduced(std::move(ranges));
+        }
+
+    } // anonymous namespace
+
+
+    ConcurrentPool::Reader::Reader(ConcurrentPool& pool, detail::ReaderSlot& slot) noexcept
+        : pool_(pool)
+        , slot_(slot)
+    {
+    }
+
+
+    ConcurrentPool::Reader::~Reader()
+    {
+        const std::lock_guard lock(pool_.writers_mutex_);
+        slot_.in_use = false;
+    }
+
+
+    bool ConcurrentPool::Reader::contains(const IPAddress address) const
+    {
+        return read([address](const Snapshot& snapshot) { return snapshot.index.contains(address); });
+    }
+
+
+    void ConcurrentPool::Reader::contains(const std::span<const IPAddress> addresses, const std::span<std::uint64_t> bitmask) const
+    {
+        read([addresses, bitmask](const Snapshot& snapshot) { snapshot.index.contains(addresses, bitmask); });
+    }
+
+
+    ConcurrentPool::ConcurrentPool(NormalizedPool pool)
+    {
+        PoolIndex index(pool);
+        current_.store(new Snapshot{std::move(pool), std::move(index), 0}, std::memory_order_release);
+    }
+
+
+    ConcurrentPool::~ConcurrentPool()
+    {
+        assert(std::none_of(slots_.cbegin(), slots_.cend(), [](const auto& slot) { return slot->in_use; }));
+        delete current_.load(std::memory_order_acquire);
+    }
+
+
+    ConcurrentPool::Reader ConcurrentPool::make_reader()
+    {
+        const std::lock_guard lock(writers_mutex_);
+        auto iter = std::find_if(slots_.begin(), slots_.end(), [](const auto& slot) { return !slot->in_use; });
+        if (iter == slots_.end())
+        {
+            slots_.push_back(std::make_unique<detail::ReaderSlot>());
+            iter = std::prev(slots_.end());
+        }
+        (*iter)->in_use = true;
+        return Reader(*this, **iter);
+    }
+
+
+    void ConcurrentPool::apply(const Pool& removed, const Pool& added)
+    {
+        const std::lock_guard lock(writers_mutex_);
+        // Writers are serialized, so the current version can't be reclaimed while it's read
+        NormalizedPool pool = applyUpdate(current_.load(std::memory_order_acquire)->pool, removed, added);
+        PoolIndex index(pool);
+        publish(std::make_unique<Snapshot>(Snapshot{std::move(pool), std::move(index), 0}));
+    }
+
+
+    void ConcurrentPool::assign(NormalizedPool pool)
+    {
+        PoolIndex index(pool);
+        const std::lock_guard lock(writers_mutex_);
+        publish(std::make_unique<Snapshot>(Snapshot{std::move(pool), std::move(index), 0}));
+    }
+
+
+    std::uint64_t ConcurrentPool::version() const
+    {
+        const std::lock_guard lock(writers_mutex_);
+        return current_.load(std::memory_order_acquire)->number;
+    }
+
+
+    std::size_t ConcurrentPool::retired_count() const
+    {
+        const std::lock_guard lock(writers_mutex_);
+        return retired_.size();
+    }
+
+
+    void ConcurrentPool::publish(std::unique_ptr<Snapshot> snapshot)
+    {
+        const Snapshot* const previous = current_.load(std::memory_order_relaxed);
+        snapshot->number = previous->number + 1;
+        current_.store(snapshot.release(), std::memory_order_seq_cst);
+
+        const std::uint64_t epoch = epoch_.load(std::memory_order_relaxed);
+        retired_.emplace_back(previous, epoch);
+        epoch_.store(epoch + 1, std::memory_order_release);
+        reclaim();
+    }
+
+
+    void ConcurrentPool::reclaim()
+    {
+        // Pairs with the fence of `enter`
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::uint64_t min_epoch = detail::ReaderSlot::idle;
+        for (const auto& slot : slots_)
+        {
+            min_epoch = std::min(min_epoch, slot->epoch.load(std::memory_order_acquire));
+        }
+        std::erase_if(retired_, [min_epoch](const auto& retired) { return retired.second < min_epoch; });
+    }
+
+} // namespace netup_tt
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "ipv4_pools.h"
+#include "normalized_pool.h"
+#include "pool_index.h"
+
+
+namespace netup_tt
+{
+
+    namespace detail
+    {
+
+        // Epoch announced by a reader while it reads, every reader has its own cache line
+        struct alignas(64) ReaderSlot
+        {
+            static constexpr std::uint64_t idle = std::numeric_limits<std::uint64_t>::max();
+
+            std::atomic<std::uint64_t> epoch{idle};
+            // Changed only under the writers' mutex
+            bool in_use{false};
+        };
+
+    } // namespace detail
+
+
+    // Pool for many reader threads and rare writers (like the data plane and the control plane).
+    // Readers work with immutable versions of the pool and never wait: a read is a few atomic
+    // operations on the reader's own slot and one load of the pointer to the current version.
+    // Writers are serialized, they build a new version aside and publish it by swapping the pointer,
+    // so readers see either the old version or the new one, never a half-applied update.
+    //
+    // Old versions are reclaimed with epoch-based reclamation:
+    //
+    //     reader   announces the global epoch in its slot, loads the current version, ..., becomes idle
+    //     writer   swaps the version, retires the old one with the current epoch E, moves to E + 1,
+    //              frees every retired version older than epochs of all active readers
+    //
+    // A reader which has announced E + 1 or later has loaded the new version already, so only readers
+    // which are active since E or earlier may still use a version retired at E.
+    class ConcurrentPool
+    {
+    public:
+        // Immutable version of the pool
+        struct Snapshot
+        {
+            NormalizedPool pool;
+            // Lookups of `pool`
+            PoolIndex index;
+            // Versions are numbered from 0, in the order of publishing
+            std::uint64_t number{0};
+        };
+
+
+        // Handle of one reader thread: every thread reading the pool should have its own one.
+        // Reads of one reader shouldn't be nested.
+        class Reader
+        {
+        public:
+            ~Reader();
+
+            Reader(const Reader&) = delete;
+            Reader& operator=(const Reader&) = delete;
+
+            // Calls `function(const Snapshot&)` with the current version, which is valid until it returns
+            template <typename Function>
+                requires std::invocable<Function&, const Snapshot&>
+            decltype(auto) read(Function&& function) const
+            {
+                const Guard guard(slot_);
+                return std::invoke(function, pool_.enter(slot_));
+            }
+
+            bool contains(IPAddress address) const;
+            // See `PoolIndex::contains`, all addresses are looked up in the same version
+            void contains(std::span<const IPAddress> addresses, std::span<std::uint64_t> bitmask) const;
+
+        private:
+            friend class ConcurrentPool;
+
+            // Makes the slot idle when the read is over, even if it has thrown
+            class Guard
+            {
+            public:
+                explicit Guard(detail::ReaderSlot& slot) noexcept : slot_(slot) {}
+                ~Guard() { slot_.epoch.store(detail::ReaderSlot::idle, std::memory_order_release); }
+
+                Guard(const Guard&) = delete;
+                Guard& operator=(const Guard&) = delete;
+
+            private:
+                detail::ReaderSlot& slot_;
+            };
+
+            Reader(ConcurrentPool& pool, detail::ReaderSlot& slot) noexcept;
+
+            ConcurrentPool& pool_;
+            detail::ReaderSlot& slot_;
+        };
+
+
+        explicit ConcurrentPool(NormalizedPool pool = NormalizedPool());
+        // All readers should be destroyed before the pool
+        ~ConcurrentPool();
+
+        ConcurrentPool(const ConcurrentPool&) = delete;
+        ConcurrentPool& operator=(const ConcurrentPool&) = delete;
+
+        // Registers a reader (takes the writers' mutex)
+        Reader make_reader();
+
+        // Publishes `(current \ removed) ∪ added` as a new version
+        void apply(const Pool& removed, const Pool& added);
+        // Publishes `pool` as a new version
+        void assign(NormalizedPool pool);
+
+        // Number of the current version
+        std::uint64_t version() const;
+        // Versions which have been replaced, but may still be used by readers
+        std::size_t retired_count() const;
+
+    private:
+        const Snapshot& enter(detail::ReaderSlot& slot) const noexcept
+        {
+            assert(slot.epoch.load(std::memory_order_relaxed) == detail::ReaderSlot::idle);
+            slot.epoch.store(epoch_.load(std::memory_order_acquire), std::memory_order_relaxed);
+            // Pairs with the fence of `reclaim`: either the writer sees the announced epoch,
+            // or the reader sees the version published before the writer has moved the epoch
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            return *current_.load(std::memory_order_acquire);
+        }
+
+        // Should be called under `writers_mutex_`
+        void publish(std::unique_ptr<Snapshot> snapshot);
+        void reclaim();
+
+        // Both are read by all readers and changed only by writers
+        alignas(64) std::atomic<const Snapshot*> current_;
+        std::atomic<std::uint64_t> epoch_{0};
+
+        alignas(64) mutable std::mutex writers_mutex_;
+        // Slots are never freed until the pool is destroyed, they are reused by new readers
+        std::vector<std::unique_ptr<detail::ReaderSlot>> slots_;
+        // Replaced versions with epochs when they have been retired
+        std::vector<std::pair<std::unique_ptr<const Snapshot>, std::uint64_t>> retired_;
+    };
+
+} // namespace netup_tt
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+#include "ipv4_pools.h"
+#include "normalized_pool.h"
+
+
+namespace netup_tt
+{
+
+    struct DiffStats
+    {
+        std::size_t ranges_count{0};
+        // 64-bit, the whole address space is 2^32 addresses
+        std::uint64_t addresses_count{0};
+
+        bool operator==(const DiffStats&) const = default;
+    };
+
+
+    namespace detail
+    {
+
+        // Counts reduced ranges of diff and their addresses as they are emitted by the merge,
+        // optionally spreading addresses over networks of the histogram:
+        //
+        //     range      [  .. 1.255.0.0 ............................... 3.0.0.9 ]
+        //     /8         1: 65536          2: 16777216                    3: 10
+        class DiffStatsCounter
+        {
+        public:
+            DiffStatsCounter() = default;
+
+            // `histogram` has a counter for every network of `prefix_length` bits
+            DiffStatsCounter(const std::uint8_t prefix_length, const std::span<std::uint64_t> histogram)
+                : histogram_(histogram)
+                , network_bits_(32 - prefix_length)
+            {
+                if (prefix_length > 16 || histogram.size() != std::size_t{1} << prefix_length)
+                {
+                    throw std::invalid_argument(
+                        "Histogram for prefix length " + std::to_string(prefix_length)
+                        + " should be 2^prefix_length counters (prefix length is at most 16)"
+                    );
+                }
+                std::fill(histogram_.begin(), histogram_.end(), 0);
+            }
+
+            void operator()(const IPAddress first, const IPAddress last) noexcept
+            {
+                ++stats_.ranges_count;
+                stats_.addresses_count += std::uint64_t{last} - first + 1;
+                if (histogram_.empty())
+                {
+                    return;
+                }
+                // 64-bit arithmetic, networks of /0 have 2^32 addresses
+                const std::uint64_t first_network = std::uint64_t{first} >> network_bits_;
+                const std::uint64_t last_network = std::uint64_t{last} >> network_bits_;
+                std::uint64_t network_first = first;
+                for (std::uint64_t network = first_network; network <= last_network; ++network)
+                {
+                    const std::uint64_t network_last = std::min<std::uint64_t>(last, ((network + 1) << network_bits_) - 1);
+                    histogram_[network] += network_last - network_first + 1;
+                    network_first = network_last + 1;
+                }
+            }
+
+            const DiffStats& stats() const noexcept { return stats_; }
+
+        private:
+            DiffStats stats_;
+            std::span<std::uint64_t> histogram_;
+            int network_bits_{32};
+        };
+
+
+        template <typename OldPool, typename NewPool>
+        DiffStats countDiff(const OldPool& old_pool, const NewPool& new_pool, DiffStatsCounter counter)
+        {
+            if constexpr (HasNormalizedPool<OldPool, NewPool>)
+            {
+                // Galloping, if one of pools is much bigger
+                find_diff(old_pool, new_pool, [&counter](const Range& range) { counter(range.first, range.second); });
+            }
+            else
+            {
+                findDiff(makeRangesReader(old_pool), makeRangesReader(new_pool), counter);
+            }
+            return counter.stats();
+        }
+
+    } // namespace detail
+
+
+    // Number of ranges and addresses of `old_pool \ new_pool` without materializing the diff:
+    // reduced ranges are counted by the same merge as `find_diff` does, nothing is allocated.
+    // Pools may be `Pool`, `FlatPool` or `NormalizedPool` in any combination.
+    template <typename OldPool, typename NewPool>
+        requires detail::AnyPool<OldPool> && detail::AnyPool<NewPool>
+    DiffStats diff_stats(const OldPool& old_pool, const NewPool& new_pool)
+    {
+        return detail::countDiff(old_pool, new_pool, detail::DiffStatsCounter());
+    }
+
+    // Same, and addresses of diff in every network of `prefix_length` bits (at most 16) are written
+    // to `histogram`, which should have 2^prefix_length counters: e.g. 256 counters of /8 networks
+    // or 65536 counters of /16 networks. Throws `std::invalid_argument` if its size doesn't match.
+    template <typename OldPool, typename NewPool>
+        requires detail::AnyPool<OldPool> && detail::AnyPool<NewPool>
+    DiffStats diff_stats(
+        const OldPool& old_pool,
+        const NewPool& new_pool,
+        const std::uint8_t prefix_length,
+        const std::span<std::uint64_t> histogram
+    )
+    {
+        return detail::countDiff(old_pool, new_pool, detail::DiffStatsCounter(prefix_length, histogram));
+    }
+
+} // namespace netup_tt
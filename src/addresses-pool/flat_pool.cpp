@@ -0,0 +1,57 @@
+#include "flat_pool.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+
+namespace netup_tt
+{
+
+    namespace
+    {
+
+        bool areReduced(const std::vector<Range>& ranges)
+        {
+            return std::adjacent_find(ranges.cbegin(), ranges.cend(), [](const Range& previous, const Range& next)
+            {
+                return next.first <= previous.second || next.first - previous.second == 1;
+            }) == ranges.cend();
+        }
+
+    } // anonymous namespace
+
+
+    FlatPool::FlatPool(const Pool& pool)
+        : ranges_(pool.cbegin(), pool.cend())
+        , reduced_(areReduced(ranges_))
+    {
+    }
+
+
+    FlatPool::FlatPool(std::vector<Range> ranges)
+        : ranges_(std::move(ranges))
+    {
+        if (!std::is_sorted(ranges_.cbegin(), ranges_.cend()))
+        {
+            std::sort(ranges_.begin(), ranges_.end());
+        }
+        ranges_.erase(std::unique(ranges_.begin(), ranges_.end()), ranges_.end());
+        reduced_ = areReduced(ranges_);
+    }
+
+
+    Pool FlatPool::to_pool() const
+    {
+        // Sorted input makes every insertion amortized constant
+        return Pool(ranges_.cbegin(), ranges_.cend());
+    }
+
+
+    void find_diff(const FlatPool& old_pool, const FlatPool& new_pool, std::vector<Range>& diff)
+    {
+        diff.clear();
+        find_diff(old_pool, new_pool, std::back_inserter(diff));
+    }
+
+} // namespace netup_tt
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+
+#include <concepts>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#include "ipv4_pools.h"
+
+
+namespace netup_tt
+{
+
+    // Same set of ranges as `Pool`, but stored in one sorted contiguous array
+    // instead of a tree, so walking over it doesn't chase pointers.
+    // Ranges are kept as they are, i.e. they still may intersect or be adjacent.
+    // Whether they do is found out on construction, and `find_diff` relies on it
+    // to search through reduced pools instead of walking over them (see below).
+    class FlatPool
+    {
+    public:
+        using const_iterator = std::vector<Range>::const_iterator;
+
+        FlatPool() = default;
+        explicit FlatPool(const Pool& pool);
+        // `ranges` may be in any order and contain duplicates,
+        // they are sorted and deduplicated (like `Pool` does)
+        explicit FlatPool(std::vector<Range> ranges);
+
+        Pool to_pool() const;
+
+        const std::vector<Range>& ranges() const noexcept { return ranges_; }
+        // True if ranges don't intersect and aren't adjacent (like ranges of `find_diff` result)
+        bool is_reduced() const noexcept { return reduced_; }
+        std::size_t size() const noexcept { return ranges_.size(); }
+        bool empty() const noexcept { return ranges_.empty(); }
+        const_iterator begin() const noexcept { return ranges_.cbegin(); }
+        const_iterator end() const noexcept { return ranges_.cend(); }
+
+        bool operator==(const FlatPool&) const = default;
+
+    private:
+        std::vector<Range> ranges_;
+        bool reduced_{true};
+    };
+
+
+    // Same as `find_diff` for `Pool`, but writes result into `diff`.
+    // Previous contents of `diff` are discarded while its capacity is kept,
+    // so one preallocated vector may be reused between calls.
+    void find_diff(const FlatPool& old_pool, const FlatPool& new_pool, std::vector<Range>& diff);
+
+
+    // Streaming versions, like the ones for `Pool`.
+    // When one pool is much bigger than the other one and it's reduced, diff is found by
+    // galloping (exponential search) over the bigger pool, so it costs O(m log(n/m))
+    // searches plus the size of the result, instead of walking over all n + m ranges.
+
+    template <typename Sink>
+        requires std::invocable<Sink&, const Range&>
+    void find_diff(const FlatPool& old_pool, const FlatPool& new_pool, Sink&& sink)
+    {
+        const auto emit = [&sink](const IPAddress first, const IPAddress last) { std::invoke(sink, Range{first, last}); };
+        detail::ReducedRangesReader next_old(old_pool.begin(), old_pool.end());
+        detail::ReducedRangesReader next_new(new_pool.begin(), new_pool.end());
+
+        if (new_pool.is_reduced() && detail::isWorthGalloping(new_pool.size(), old_pool.size()))
+        {
+            detail::findDiffGallopingNew(next_old, new_pool.begin(), new_pool.end(), emit);
+        }
+        else if (old_pool.is_reduced() && detail::isWorthGalloping(old_pool.size(), new_pool.size()))
+        {
+            detail::findDiffGallopingOld(old_pool.begin(), old_pool.end(), next_new, emit);
+        }
+        else
+        {
+            detail::findDiff(next_old, next_new, emit);
+        }
+    }
+
+    template <typename OutputIterator>
+        requires std::output_iterator<OutputIterator, Range>
+    OutputIterator find_diff(const FlatPool& old_pool, const FlatPool& new_pool, OutputIterator out)
+    {
+        find_diff(old_pool, new_pool, [&out](const Range& range) { *out++ = range; });
+        return out;
+    }
+
+} // namespace netup_tt
@@ -1,5 +1,11 @@
+#pragma once
+
 #include <cstdint>
 
+#include <concepts>
+#include <functional>
+#include <iterator>
+#include <memory>
 #include <set>
 #include <utility>
 
@@ -13,3 +19,59 @@ namespace netup_tt
 
     Pool find_diff(const Pool& old_pool, const Pool& new_pool);
 } 
+
+#include "pool_diff_impl.h"
+
+namespace netup_tt
+{
+    // Pools of other address types (see "ipv6_pools.h"). The diff algorithm itself doesn't depend
+    // on width of addresses, so the same templates are instantiated for every type,
+    // and the code for IPv4 addresses is the same as if it was written for them only.
+    template <typename Address>
+    using BasicRange = std::pair<Address, Address>;
+
+    // Allocator may be changed, e.g. to allocate pools from an arena (see "pmr_pools.h")
+    template <typename Address, typename Allocator = std::allocator<BasicRange<Address>>>
+    using BasicPool = std::set<BasicRange<Address>, std::less<BasicRange<Address>>, Allocator>;
+
+    // Streaming versions of `find_diff`: ranges of diff are passed to `sink` (or written 
+    // to `out`) in ascending order as soon as they are found, nothing is materialized. 
+    // Pools may have different allocators.
+
+    template <typename Address, typename OldAllocator, typename NewAllocator, typename Sink>
+        requires std::invocable<Sink&, const BasicRange<Address>&>
+    void find_diff(
+        const BasicPool<Address, OldAllocator>& old_pool, 
+        const BasicPool<Address, NewAllocator>& new_pool, 
+        Sink&& sink
+    )
+    {
+        detail::findDiff(
+            detail::ReducedRangesReader(old_pool.cbegin(), old_pool.cend()), 
+            detail::ReducedRangesReader(new_pool.cbegin(), new_pool.cend()), 
+            [&sink](const Address& first, const Address& last) { std::invoke(sink, BasicRange<Address>{first, last}); }
+        );
+    }
+
+    // Returns iterator past the last written range
+    template <typename Address, typename OldAllocator, typename NewAllocator, typename OutputIterator>
+        requires std::output_iterator<OutputIterator, BasicRange<Address>>
+    OutputIterator find_diff(
+        const BasicPool<Address, OldAllocator>& old_pool, 
+        const BasicPool<Address, NewAllocator>& new_pool, 
+        OutputIterator out
+    )
+    {
+        find_diff(old_pool, new_pool, [&out](const BasicRange<Address>& range) { *out++ = range; });
+        return out;
+    }
+
+    // Same as `find_diff` for `Pool` (which is a plain function, this template isn't used for it)
+    template <typename Address>
+    BasicPool<Address> find_diff(const BasicPool<Address>& old_pool, const BasicPool<Address>& new_pool)
+    {
+        BasicPool<Address> diff;
+        find_diff(old_pool, new_pool, [&diff](const BasicRange<Address>& range) { diff.emplace_hint(diff.cend(), range); });
+        return diff;
+    }
+}
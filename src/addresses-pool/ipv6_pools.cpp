@@ -0,0 +1,9 @@
+#include "ipv6_pools.h"
+
+
+namespace netup_tt
+{
+
+    template IPv6Pool find_diff<IPv6Address>(const IPv6Pool& old_pool, const IPv6Pool& new_pool);
+
+} // namespace netup_tt
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+
+#include "ipv4_pools.h"
+
+
+namespace netup_tt
+{
+
+    // 128-bit unsigned number made of two 64-bit halves, for compilers which don't have `unsigned __int128`.
+    // It has only what the diff needs (comparisons, addition and subtraction), every operation
+    // is a couple of instructions on the halves, without any generic big number machinery.
+    struct Uint128
+    {
+        // `high` goes first, so the default comparison compares numbers
+        std::uint64_t high{0};
+        std::uint64_t low{0};
+
+        constexpr Uint128() noexcept = default;
+        // Implicit, so that expressions like `address + 1` work the same as for built-in types
+        constexpr Uint128(const std::uint64_t value) noexcept
+            : low(value)
+        {
+        }
+        constexpr Uint128(const std::uint64_t high_half, const std::uint64_t low_half) noexcept
+            : high(high_half)
+            , low(low_half)
+        {
+        }
+
+        friend constexpr Uint128 operator+(const Uint128& lhs, const Uint128& rhs) noexcept
+        {
+            const std::uint64_t low = lhs.low + rhs.low;
+            const std::uint64_t carry = low < lhs.low ? 1 : 0;
+            return {lhs.high + rhs.high + carry, low};
+        }
+
+        friend constexpr Uint128 operator-(const Uint128& lhs, const Uint128& rhs) noexcept
+        {
+            const std::uint64_t borrow = lhs.low < rhs.low ? 1 : 0;
+            return {lhs.high - rhs.high - borrow, lhs.low - rhs.low};
+        }
+
+        friend constexpr bool operator==(const Uint128&, const Uint128&) noexcept = default;
+        friend constexpr std::strong_ordering operator<=>(const Uint128&, const Uint128&) noexcept = default;
+    };
+
+
+    // The native type is used where the compiler has it, since it's handled in pairs of registers
+    // with carry flag by the compiler itself
+#ifdef __SIZEOF_INT128__
+    // `__extension__` keeps pedantic compilers quiet about the non-standard type
+    __extension__ typedef unsigned __int128 IPv6Address;
+    inline constexpr IPv6Address max_ipv6_address = ~IPv6Address{0};
+#else
+    using IPv6Address = Uint128;
+    inline constexpr IPv6Address max_ipv6_address{~std::uint64_t{0}, ~std::uint64_t{0}};
+#endif
+
+    using IPv6Range = BasicRange<IPv6Address>;
+    using IPv6Pool = BasicPool<IPv6Address>;
+
+
+    // Instantiated once, in "ipv6_pools.cpp"
+    extern template IPv6Pool find_diff<IPv6Address>(const IPv6Pool& old_pool, const IPv6Pool& new_pool);
+
+} // namespace netup_tt
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstddef>
+
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <utility>
+
+#include "ipv4_pools.h"
+#include "normalized_pool.h"
+
+
+namespace netup_tt
+{
+
+    namespace detail
+    {
+
+        // Reader of ranges of `old \ new`: the same merge as `findDiff`, but it's driven by the caller.
+        // Every call walks both readers only as far as it's needed for the next range of diff,
+        // so a caller which stops early doesn't pay for the rest of pools.
+        //
+        //     old:    [a b c d e f g h i j]----------[k l m]--
+        //     new:    ----[c d]----[g h i j k l]-------------
+        //     calls:  [a b]  [e f]  [m]  nothing
+        template <typename OldReader, typename NewReader>
+        class DiffReader
+        {
+        public:
+            using RangeType = ReaderRange<OldReader>;
+
+            DiffReader(OldReader next_old, NewReader next_new)
+                : next_old_(std::move(next_old))
+                , next_new_(std::move(next_new))
+            {
+            }
+
+            std::optional<RangeType> operator()()
+            {
+                if (!is_started_)
+                {
+                    is_started_ = true;
+                    advanceOld();
+                    new_range_ = next_new_();
+                }
+                while (old_range_)
+                {
+                    // Ranges of new pool which end before the rest of the current old range don't matter
+                    while (new_range_ && new_range_->second < start_)
+                    {
+                        new_range_ = next_new_();
+                    }
+                    if (!new_range_ || new_range_->first > old_range_->second)
+                    {
+                        const RangeType range{start_, old_range_->second};
+                        advanceOld();
+                        return range;
+                    }
+
+                    // `new_range_` intersects [start_, old end], the part before it (if any) is in diff
+                    const std::optional<RangeType> range = start_ < new_range_->first
+                        ? std::optional(RangeType{start_, new_range_->first - 1})
+                        : std::nullopt;
+                    if (new_range_->second < old_range_->second)
+                    {
+                        start_ = new_range_->second + 1;
+                    }
+                    else
+                    {
+                        advanceOld();
+                    }
+                    if (range)
+                    {
+                        return range;
+                    }
+                }
+                return std::nullopt;
+            }
+
+        private:
+            void advanceOld()
+            {
+                old_range_ = next_old_();
+                if (old_range_)
+                {
+                    start_ = old_range_->first;
+                }
+            }
+
+            OldReader next_old_;
+            NewReader next_new_;
+            std::optional<RangeType> old_range_;
+            std::optional<ReaderRange<NewReader>> new_range_;
+            // Start of the part of the current old range which hasn't been handled yet
+            ReaderAddress<OldReader> start_{};
+            bool is_started_{false};
+        };
+
+    } // namespace detail
+
+
+    // Input range (view) of ranges given by a reader, every range is read when the iterator
+    // is advanced. Like other input ranges, it may be iterated only once.
+    template <typename Reader>
+    class LazyRanges : public std::ranges::view_interface<LazyRanges<Reader>>
+    {
+    public:
+        using RangeType = detail::ReaderRange<Reader>;
+
+        class iterator
+        {
+        public:
+            using iterator_concept = std::input_iterator_tag;
+            using value_type = RangeType;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+
+            const RangeType& operator*() const { return *parent_->current_; }
+            const RangeType* operator->() const { return &*parent_->current_; }
+
+            iterator& operator++()
+            {
+                parent_->current_ = (*parent_->reader_)();
+                return *this;
+            }
+
+            void operator++(int) { ++*this; }
+
+            friend bool operator==(const iterator& iter, std::default_sentinel_t) { return iter.isOver(); }
+
+        private:
+            friend class LazyRanges;
+
+            explicit iterator(LazyRanges* const parent) : parent_(parent) {}
+
+            bool isOver() const { return !parent_->current_; }
+
+            LazyRanges* parent_{nullptr};
+        };
+
+        LazyRanges() = default;
+        explicit LazyRanges(Reader reader) : reader_(std::move(reader)) {}
+
+        iterator begin()
+        {
+            if (!is_started_)
+            {
+                is_started_ = true;
+                current_ = (*reader_)();
+            }
+            return iterator(this);
+        }
+
+        std::default_sentinel_t end() const noexcept { return {}; }
+
+    private:
+        // Optional, so that the view is default constructible (as views should be) whatever the reader is
+        std::optional<Reader> reader_;
+        std::optional<RangeType> current_;
+        bool is_started_{false};
+    };
+
+
+    // Lazy `find_diff`: ranges of `old_pool \ new_pool` are found one by one, as they are iterated.
+    // Pools are walked only as far as the taken ranges need, e.g. to find the first free block:
+    //
+    //     for (const Range& range : lazy_diff(capacity, allocated)) { if (fits(range)) { ... break; } }
+    //
+    // Pools may be `Pool`, `FlatPool` or `NormalizedPool` in any combination,
+    // they should outlive the view. Ranges are reduced and go in ascending order.
+    template <typename OldPool, typename NewPool>
+        requires detail::AnyPool<OldPool> && detail::AnyPool<NewPool>
+    auto lazy_diff(const OldPool& old_pool, const NewPool& new_pool)
+    {
+        using Reader = detail::DiffReader<
+            decltype(detail::makeRangesReader(old_pool)),
+            decltype(detail::makeRangesReader(new_pool))
+        >;
+        return LazyRanges<Reader>(Reader(detail::makeRangesReader(old_pool), detail::makeRangesReader(new_pool)));
+    }
+
+    // True if every address of `pool` is in `other`. Stops at the first address which isn't.
+    template <typename Pool1, typename Pool2>
+        requires detail::AnyPool<Pool1> && detail::AnyPool<Pool2>
+    bool is_subset(const Pool1& pool, const Pool2& other)
+    {
+        auto diff = lazy_diff(pool, other);
+        return diff.begin() == diff.end();
+    }
+
+} // namespace netup_tt
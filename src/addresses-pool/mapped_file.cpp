@@ -0,0 +1,175 @@
+#include "mapped_file.h"
+
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace netup_tt
+{
+
+    namespace
+    {
+
+#ifdef _WIN32
+
+        [[noreturn]] void throwLastError(const std::filesystem::path& path, const char* const what)
+        {
+            throw std::system_error(
+                static_cast<int>(::GetLastError()), std::system_category(), what + (": " + path.string())
+            );
+        }
+
+
+        // Closes a handle when goes out of scope, the view of a mapping doesn't need handles to stay open
+        struct HandleCloser
+        {
+            HANDLE handle;
+            ~HandleCloser() { ::CloseHandle(handle); }
+        };
+
+#else
+
+        [[noreturn]] void throwErrno(const std::filesystem::path& path, const char* const what)
+        {
+            throw std::system_error(errno, std::generic_category(), what + (": " + path.string()));
+        }
+
+
+        // Closes a descriptor when goes out of scope, the mapping doesn't need it to stay open
+        struct DescriptorCloser
+        {
+            int descriptor;
+            ~DescriptorCloser() { ::close(descriptor); }
+        };
+
+#endif
+
+    } // anonymous namespace
+
+
+    MappedFile::MappedFile(const std::filesystem::path& path, const Access access)
+    {
+#ifdef _WIN32
+        const HANDLE file = ::CreateFileW(
+            path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            access == Access::sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL, nullptr
+        );
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            throwLastError(path, "Can't open file");
+        }
+        const HandleCloser file_closer{file};
+
+        LARGE_INTEGER file_size;
+        if (!::GetFileSizeEx(file, &file_size))
+        {
+            throwLastError(path, "Can't get size of file");
+        }
+        if (file_size.QuadPart == 0)
+        {
+            return;
+        }
+
+        const HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr)
+        {
+            throwLastError(path, "Can't map file");
+        }
+        const HandleCloser mapping_closer{mapping};
+
+        const void* const data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (data == nullptr)
+        {
+            throwLastError(path, "Can't map file");
+        }
+        data_ = static_cast<const std::byte*>(data);
+        size_ = static_cast<std::size_t>(file_size.QuadPart);
+#else
+        const int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (descriptor == -1)
+        {
+            throwErrno(path, "Can't open file");
+        }
+        const DescriptorCloser descriptor_closer{descriptor};
+
+        struct stat file_status{};
+        if (::fstat(descriptor, &file_status) == -1)
+        {
+            throwErrno(path, "Can't get size of file");
+        }
+        if (file_status.st_size == 0)
+        {
+            return;
+        }
+
+        const auto size = static_cast<std::size_t>(file_status.st_size);
+        void* const data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (data == MAP_FAILED)
+        {
+            throwErrno(path, "Can't map file");
+        }
+        if (access == Access::sequential)
+        {
+            // Just a hint, so failures are ignored
+            ::madvise(data, size, MADV_SEQUENTIAL);
+        }
+        data_ = static_cast<const std::byte*>(data);
+        size_ = size;
+#endif
+    }
+
+
+    MappedFile::~MappedFile()
+    {
+        unmap();
+    }
+
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+    {
+    }
+
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            unmap();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+
+    void MappedFile::unmap() noexcept
+    {
+        if (data_ == nullptr)
+        {
+            return;
+        }
+#ifdef _WIN32
+        ::UnmapViewOfFile(data_);
+#else
+        ::munmap(const_cast<std::byte*>(data_), size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+} // namespace netup_tt
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+
+#include <filesystem>
+#include <span>
+
+
+namespace netup_tt
+{
+
+    // Read-only memory mapping of a whole file (POSIX `mmap` or Windows file mapping).
+    // Empty files aren't mapped, their `bytes()` is empty.
+    // Failures to open or map a file are thrown as `std::system_error`.
+    class MappedFile
+    {
+    public:
+        // Hint for the OS about the order in which pages are going to be read
+        enum class Access
+        {
+            normal,
+            // Pages are read ahead more aggressively and may be dropped soon after they are passed
+            sequential
+        };
+
+        MappedFile() = default;
+        explicit MappedFile(const std::filesystem::path& path, Access access = Access::normal);
+        ~MappedFile();
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        std::span<const std::byte> bytes() const noexcept { return {data_, size_}; }
+
+    private:
+        void unmap() noexcept;
+
+        const std::byte* data_{nullptr};
+        std::size_t size_{0};
+    };
+
+} // namespace netup_tt
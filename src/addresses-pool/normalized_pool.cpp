@@ -0,0 +1,124 @@
+#include "normalized_pool.h"
+
+#include <algorithm>
+#include <cassert>
+
+
+namespace netup_tt
+{
+
+    namespace
+    {
+
+        template <typename Reader>
+        std::vector<Range> readAll(Reader&& next_range)
+        {
+            std::vector<Range> ranges;
+            while (const auto range = next_range())
+            {
+                ranges.push_back(*range);
+            }
+            return ranges;
+        }
+
+    } // anonymous namespace
+
+
+    NormalizedPool::NormalizedPool(const Pool& pool)
+        : ranges_(readAll(detail::makeRangesReader(pool)))
+    {
+    }
+
+
+    NormalizedPool::NormalizedPool(const FlatPool& pool)
+        : ranges_(pool.is_reduced() ? pool.ranges() : readAll(detail::makeRangesReader(pool)))
+    {
+    }
+
+
+    NormalizedPool NormalizedPool::from_reduced(std::vector<Range> ranges)
+    {
+        assert(std::is_sorted(ranges.cbegin(), ranges.cend()) && FlatPool(ranges).is_reduced());
+        NormalizedPool pool;
+        pool.ranges_ = std::move(ranges);
+        return pool;
+    }
+
+
+    void NormalizedPool::insert(const Range& range)
+    {
+        // Ranges which intersect `range` or touch it are [touched_begin, touched_end).
+        // Conditions are written so that they don't overflow at the limits of `IPAddress`
+        const auto touched_begin = std::partition_point(ranges_.begin(), ranges_.end(), [&range](const Range& current)
+        {
+            return current.second < range.first && range.first - current.second > 1;
+        });
+        const auto touched_end = std::partition_point(touched_begin, ranges_.end(), [&range](const Range& current)
+        {
+            return current.first <= range.second || current.first - range.second == 1;
+        });
+
+        if (touched_begin == touched_end)
+        {
+            ranges_.insert(touched_begin, range);
+            return;
+        }
+
+        touched_begin->first = std::min(touched_begin->first, range.first);
+        touched_begin->second = std::max(std::prev(touched_end)->second, range.second);
+        ranges_.erase(std::next(touched_begin), touched_end);
+    }
+
+
+    void NormalizedPool::erase(const Range& range)
+    {
+        // Ranges which intersect `range` are [touched_begin, touched_end)
+        const auto touched_begin = std::partition_point(ranges_.begin(), ranges_.end(), [&range](const Range& current)
+        {
+            return current.second < range.first;
+        });
+        const auto touched_end = std::partition_point(touched_begin, ranges_.end(), [&range](const Range& current)
+        {
+            return current.first <= range.second;
+        });
+        if (touched_begin == touched_end)
+        {
+            return;
+        }
+
+        // Parts of the first and the last touched ranges outside of `range` are kept
+        //
+        //     ranges    [-----]   [---]   [-------]
+        //     range         [.................]
+        //     kept      [---]                 [---]
+        const bool keep_left = touched_begin->first < range.first;
+        const bool keep_right = std::prev(touched_end)->second > range.second;
+        const Range left{touched_begin->first, range.first - 1};
+        const Range right{range.second + 1, std::prev(touched_end)->second};
+        if (keep_left && keep_right && std::next(touched_begin) == touched_end)
+        {
+            // `range` is inside of one range, which is split in two
+            *touched_begin = left;
+            ranges_.insert(touched_end, right);
+            return;
+        }
+
+        auto kept_end = touched_begin;
+        if (keep_left)
+        {
+            *kept_end++ = left;
+        }
+        if (keep_right)
+        {
+            *kept_end++ = right;
+        }
+        ranges_.erase(kept_end, touched_end);
+    }
+
+
+    Pool NormalizedPool::to_pool() const
+    {
+        return Pool(ranges_.cbegin(), ranges_.cend());
+    }
+
+} // namespace netup_tt
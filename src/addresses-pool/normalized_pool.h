@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+
+#include <concepts>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "flat_pool.h"
+#include "ipv4_pools.h"
+
+
+namespace netup_tt
+{
+
+    // Pool which ranges are always reduced: they are sorted, don't intersect and aren't adjacent
+    // (i.e. they look like ranges of `find_diff` result). Reduction is done once, on construction
+    // or on insertion, so diffs with this pool don't need to reduce its ranges again and again.
+    class NormalizedPool
+    {
+    public:
+        using const_iterator = std::vector<Range>::const_iterator;
+
+        NormalizedPool() = default;
+        explicit NormalizedPool(const Pool& pool);
+        explicit NormalizedPool(const FlatPool& pool);
+
+        // Takes ranges which are known to be reduced already, they aren't checked in release builds
+        static NormalizedPool from_reduced(std::vector<Range> ranges);
+
+        // Adds `range` merging it with all ranges it intersects or touches.
+        // Costs O(log n) plus shift of the following ranges, so appending in ascending order is cheap.
+        void insert(const Range& range);
+        // Removes addresses of `range`, cutting ranges which it intersects. Costs the same as `insert`.
+        void erase(const Range& range);
+
+        Pool to_pool() const;
+
+        const std::vector<Range>& ranges() const noexcept { return ranges_; }
+        std::size_t size() const noexcept { return ranges_.size(); }
+        bool empty() const noexcept { return ranges_.empty(); }
+        const_iterator begin() const noexcept { return ranges_.cbegin(); }
+        const_iterator end() const noexcept { return ranges_.cend(); }
+
+        bool operator==(const NormalizedPool&) const = default;
+
+    private:
+        std::vector<Range> ranges_;
+    };
+
+
+    namespace detail
+    {
+
+        template <typename T>
+        concept AnyPool = std::same_as<T, Pool> || std::same_as<T, FlatPool> || std::same_as<T, NormalizedPool>;
+
+        template <typename OldPool, typename NewPool>
+        concept HasNormalizedPool = AnyPool<OldPool> && AnyPool<NewPool>
+            && (std::same_as<OldPool, NormalizedPool> || std::same_as<NewPool, NormalizedPool>);
+
+        inline auto makeRangesReader(const Pool& pool)
+        {
+            return ReducedRangesReader(pool.cbegin(), pool.cend());
+        }
+
+        inline auto makeRangesReader(const FlatPool& pool)
+        {
+            return ReducedRangesReader(pool.begin(), pool.end());
+        }
+
+        inline auto makeRangesReader(const NormalizedPool& pool)
+        {
+            return PlainRangesReader(pool.begin(), pool.end());
+        }
+
+    } // namespace detail
+
+
+    // Overloads of `find_diff` where at least one of pools is `NormalizedPool`,
+    // the other one may be `Pool`, `FlatPool` or `NormalizedPool`.
+    // Ranges of `NormalizedPool` are merged as they are, with no reduction. If it's much bigger
+    // than the other pool, it's galloped over (like reduced `FlatPool`).
+
+    template <typename OldPool, typename NewPool, typename Sink>
+        requires detail::HasNormalizedPool<OldPool, NewPool> && std::invocable<Sink&, const Range&>
+    void find_diff(const OldPool& old_pool, const NewPool& new_pool, Sink&& sink)
+    {
+        const auto emit = [&sink](const IPAddress first, const IPAddress last) { std::invoke(sink, Range{first, last}); };
+
+        if constexpr (std::same_as<NewPool, NormalizedPool>)
+        {
+            if (detail::isWorthGalloping(new_pool.size(), old_pool.size()))
+            {
+                detail::findDiffGallopingNew(detail::makeRangesReader(old_pool), new_pool.begin(), new_pool.end(), emit);
+                return;
+            }
+        }
+        if constexpr (std::same_as<OldPool, NormalizedPool>)
+        {
+            if (detail::isWorthGalloping(old_pool.size(), new_pool.size()))
+            {
+                detail::findDiffGallopingOld(old_pool.begin(), old_pool.end(), detail::makeRangesReader(new_pool), emit);
+                return;
+            }
+        }
+        detail::findDiff(detail::makeRangesReader(old_pool), detail::makeRangesReader(new_pool), emit);
+    }
+
+    template <typename OldPool, typename NewPool, typename OutputIterator>
+        requires detail::HasNormalizedPool<OldPool, NewPool> && std::output_iterator<OutputIterator, Range>
+    OutputIterator find_diff(const OldPool& old_pool, const NewPool& new_pool, OutputIterator out)
+    {
+        find_diff(old_pool, new_pool, [&out](const Range& range) { *out++ = range; });
+        return out;
+    }
+
+    // Ranges of diff are reduced, so it's returned as `NormalizedPool`
+    template <typename OldPool, typename NewPool>
+        requires detail::HasNormalizedPool<OldPool, NewPool>
+    NormalizedPool find_diff(const OldPool& old_pool, const NewPool& new_pool)
+    {
+        std::vector<Range> diff;
+        find_diff(old_pool, new_pool, std::back_inserter(diff));
+        return NormalizedPool::from_reduced(std::move(diff));
+    }
+
+} // namespace netup_tt
@@ -0,0 +1,271 @@
+#include "parallel_diff.h"
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <optional>
+#include <thread>
+
+
+namespace netup_tt
+{
+
+    namespace
+    {
+
+        void runOnThreads(const std::size_t tasks_count, const std::function<void(std::size_t)>& task)
+        {
+            std::vector<std::exception_ptr> errors(tasks_count);
+            const auto guarded_task = [&task, &errors](const std::size_t index)
+            {
+                try
+                {
+                    task(index);
+                }
+                catch (...)
+                {
+                    errors[index] = std::current_exception();
+                }
+            };
+
+            {
+                // `std::jthread` joins on destruction, so threads are joined
+                // even if creation of one of them throws
+                std::vector<std::jthread> threads;
+                threads.reserve(tasks_count);
+                for (std::size_t index = 1; index < tasks_count; ++index)
+                {
+                    threads.emplace_back(guarded_task, index);
+                }
+                guarded_task(0);
+            }
+
+            for (const auto& error : errors)
+            {
+                if (error)
+                {
+                    std::rethrow_exception(error);
+                }
+            }
+        }
+
+
+        // Part [first, last] of the address space together with indexes of ranges which start in it
+        struct Slab
+        {
+            IPAddress first;
+            IPAddress last;
+            std::size_t old_begin;
+            std::size_t old_end;
+            std::size_t new_begin;
+            std::size_t new_end;
+            // The biggest end among ranges which start in the slab
+            std::optional<IPAddress> old_max_last;
+            std::optional<IPAddress> new_max_last;
+            std::vector<Range> diff;
+        };
+
+
+        // Reads reduced ranges which start in a slab.
+        // Ranges which start before the slab are represented by `carried` range,
+        // i.e. by their common part which gets into the slab.
+        class SlabReader
+        {
+        public:
+            SlabReader(
+                const FlatPool& pool,
+                const std::size_t begin,
+                const std::size_t end,
+                const std::optional<Range> carried
+            )
+                : carried_(carried)
+                , current_(pool.begin() + static_cast<std::ptrdiff_t>(begin))
+                , end_(pool.begin() + static_cast<std::ptrdiff_t>(end))
+            {
+            }
+
+            std::optional<Range> operator()()
+            {
+                if (!carried_)
+                {
+                    return detail::getNextReducedRange(current_, end_);
+                }
+
+                Range range = *carried_;
+                carried_.reset();
+                detail::extendReducedRange(range, current_, end_);
+                return range;
+            }
+
+        private:
+            std::optional<Range> carried_;
+            FlatPool::const_iterator current_;
+            const FlatPool::const_iterator end_;
+        };
+
+
+        std::optional<IPAddress> findMaxLast(const FlatPool& pool, const std::size_t begin, const std::size_t end)
+        {
+            if (begin == end)
+            {
+                return std::nullopt;
+            }
+            const auto& ranges = pool.ranges();
+            IPAddress max_last = ranges[begin].second;
+            for (std::size_t index = begin + 1; index < end; ++index)
+            {
+                max_last = std::max(max_last, ranges[index].second);
+            }
+            return max_last;
+        }
+
+
+        std::optional<Range> makeCarriedRange(const IPAddress slab_first, const std::optional<IPAddress> carried_last)
+        {
+            if (carried_last && *carried_last >= slab_first)
+            {
+                return Range{slab_first, *carried_last};
+            }
+            return std::nullopt;
+        }
+
+
+        std::vector<Slab> makeSlabs(const FlatPool& old_pool, const FlatPool& new_pool, const std::size_t slabs_count)
+        {
+            // Slabs boundaries are starts of ranges of the bigger pool with equal steps between them
+            const FlatPool& bigger_pool = old_pool.size() >= new_pool.size() ? old_pool : new_pool;
+            std::vector<IPAddress> slabs_firsts{0};
+            for (std::size_t slab = 1; slab < slabs_count; ++slab)
+            {
+                const IPAddress first = bigger_pool.ranges()[slab * bigger_pool.size() / slabs_count].first;
+                if (first > slabs_firsts.back())
+                {
+                    slabs_firsts.push_back(first);
+                }
+            }
+
+            const auto find_start = [](const FlatPool& pool, const IPAddress address) -> std::size_t
+            {
+                // The first range which starts at `address` or after it
+                const auto iter = std::lower_bound(pool.begin(), pool.end(), Range{address, 0});
+                return static_cast<std::size_t>(iter - pool.begin());
+            };
+
+            std::vector<Slab> slabs(slabs_firsts.size());
+            for (std::size_t index = 0; index < slabs.size(); ++index)
+            {
+                auto& slab = slabs[index];
+                const bool is_last = index + 1 == slabs.size();
+                slab.first = slabs_firsts[index];
+                slab.last = is_last ? std::numeric_limits<IPAddress>::max() : slabs_firsts[index + 1] - 1;
+                slab.old_begin = index == 0 ? 0 : slabs[index - 1].old_end;
+                slab.new_begin = index == 0 ? 0 : slabs[index - 1].new_end;
+                slab.old_end = is_last ? old_pool.size() : find_start(old_pool, slabs_firsts[index + 1]);
+                slab.new_end = is_last ? new_pool.size() : find_start(new_pool, slabs_firsts[index + 1]);
+            }
+            return slabs;
+        }
+
+    } // anonymous namespace
+
+
+    void find_diff_parallel(
+        const FlatPool& old_pool,
+        const FlatPool& new_pool,
+        std::vector<Range>& diff,
+        const ParallelDiffOptions& options
+    )
+    {
+        std::size_t slabs_count = options.slabs_count;
+        if (slabs_count == 0)
+        {
+            slabs_count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        const std::size_t bigger_size = std::max(old_pool.size(), new_pool.size());
+        slabs_count = std::min(slabs_count, bigger_size / std::max<std::size_t>(1, options.min_slab_size));
+        if (slabs_count <= 1)
+        {
+            find_diff(old_pool, new_pool, diff);
+            return;
+        }
+
+        auto slabs = makeSlabs(old_pool, new_pool, slabs_count);
+        const ParallelExecutor& execute = options.executor ? options.executor : ParallelExecutor(runOnThreads);
+
+        // Ranges which start in one slab may cover the following ones. So at first, let's find
+        // how far ranges of every slab reach, and then what is carried into every slab from previous ones
+        execute(slabs.size(), [&slabs, &old_pool, &new_pool](const std::size_t index)
+        {
+            auto& slab = slabs[index];
+            slab.old_max_last = findMaxLast(old_pool, slab.old_begin, slab.old_end);
+            slab.new_max_last = findMaxLast(new_pool, slab.new_begin, slab.new_end);
+        });
+
+        std::vector<std::optional<Range>> old_carried(slabs.size()), new_carried(slabs.size());
+        std::optional<IPAddress> old_max_last, new_max_last;
+        for (std::size_t index = 0; index < slabs.size(); ++index)
+        {
+            old_carried[index] = makeCarriedRange(slabs[index].first, old_max_last);
+            new_carried[index] = makeCarriedRange(slabs[index].first, new_max_last);
+            old_max_last = std::max(old_max_last, slabs[index].old_max_last);
+            new_max_last = std::max(new_max_last, slabs[index].new_max_last);
+        }
+
+        execute(slabs.size(), [&](const std::size_t index)
+        {
+            auto& slab = slabs[index];
+            // Ranges of the slab may stretch beyond it, they are handled by the next slabs,
+            // so diff is cut by the slab's end
+            detail::findDiff(
+                SlabReader(old_pool, slab.old_begin, slab.old_end, old_carried[index]),
+                SlabReader(new_pool, slab.new_begin, slab.new_end, new_carried[index]),
+                [&slab](const IPAddress first, const IPAddress last)
+                {
+                    if (first <= slab.last)
+                    {
+                        slab.diff.emplace_back(first, std::min(last, slab.last));
+                    }
+                }
+            );
+        });
+
+        // Per-slab results are concatenated. A diff range which crosses slabs boundaries
+        // is split between slabs, its parts should be glued back
+        std::vector<std::size_t> offsets(slabs.size());
+        std::vector<bool> glued(slabs.size(), false);
+        std::size_t diff_size = 0;
+        std::optional<IPAddress> diff_last;
+        for (std::size_t index = 0; index < slabs.size(); ++index)
+        {
+            const auto& slab_diff = slabs[index].diff;
+            offsets[index] = diff_size;
+            if (slab_diff.empty())
+            {
+                continue;
+            }
+            glued[index] = diff_last && slab_diff.front().first - *diff_last == 1;
+            diff_size += slab_diff.size() - (glued[index] ? 1 : 0);
+            diff_last = slab_diff.back().second;
+        }
+
+        diff.resize(diff_size);
+        execute(slabs.size(), [&](const std::size_t index)
+        {
+            const auto& slab_diff = slabs[index].diff;
+            const std::size_t skipped = glued[index] ? 1 : 0;
+            std::copy(
+                slab_diff.cbegin() + static_cast<std::ptrdiff_t>(skipped),
+                slab_diff.cend(),
+                diff.begin() + static_cast<std::ptrdiff_t>(offsets[index])
+            );
+        });
+        for (std::size_t index = 0; index < slabs.size(); ++index)
+        {
+            if (glued[index])
+            {
+                diff[offsets[index] - 1].second = slabs[index].diff.front().second;
+            }
+        }
+    }
+
+} // namespace netup_tt
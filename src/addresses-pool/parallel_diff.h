@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+
+#include <functional>
+#include <vector>
+
+#include "flat_pool.h"
+#include "ipv4_pools.h"
+
+
+namespace netup_tt
+{
+
+    // Runs `task(0)`, ..., `task(tasks_count - 1)` (possibly in parallel)
+    // and returns when all of them are finished.
+    using ParallelExecutor = std::function<
+        void(std::size_t tasks_count, const std::function<void(std::size_t)>& task)
+    >;
+
+
+    struct ParallelDiffOptions
+    {
+        // Number of slabs the address space is split into.
+        // 0 means `std::thread::hardware_concurrency()`
+        std::size_t slabs_count = 0;
+        // Slabs aren't made smaller than this (in ranges of the bigger pool),
+        // so small pools are handled by the calling thread only
+        std::size_t min_slab_size = 64 * 1024;
+        // Empty executor means that every slab gets its own `std::thread`
+        ParallelExecutor executor;
+    };
+
+
+    // Same as `find_diff` for `FlatPool`, but work is split between several threads.
+    // The address space is split into slabs with (roughly) the same number of ranges,
+    // each slab is diffed independently, then per-slab results are concatenated.
+    // Result is exactly the same as the one of sequential `find_diff`.
+    void find_diff_parallel(
+        const FlatPool& old_pool,
+        const FlatPool& new_pool,
+        std::vector<Range>& diff,
+        const ParallelDiffOptions& options = {}
+    );
+
+} // namespace netup_tt
@@ -0,0 +1,418 @@
+#include "persistent_pool.h"
+
+#include <cassert>
+#include <cstdint>
+
+#include <algorithm>
+#include <bit>
+#include <optional>
+
+
+namespace netup_tt
+{
+
+    namespace detail
+    {
+
+        struct PersistentPoolNode
+        {
+            // Range of a leaf
+            Range range{0, 0};
+            // Slots of an internal node which aren't empty, a leaf has none
+            std::uint16_t slots{0};
+            // Children of not empty slots in the order of slots
+            std::vector<std::shared_ptr<const PersistentPoolNode>> children;
+
+            bool is_leaf() const noexcept
+            {
+                return slots == 0;
+            }
+
+            const PersistentPoolNode* child(const unsigned slot) const noexcept
+            {
+                return (slots >> slot & 1) != 0 ? children[childIndex(slot)].get() : nullptr;
+            }
+
+            // Index of the child of `slot` (which may be empty) in `children`
+            std::size_t childIndex(const unsigned slot) const noexcept
+            {
+                return static_cast<std::size_t>(std::popcount(static_cast<unsigned>(slots) & ((1u << slot) - 1)));
+            }
+        };
+
+    } // namespace detail
+
+
+    namespace
+    {
+
+        using Node = detail::PersistentPoolNode;
+        using NodePtr = std::shared_ptr<const Node>;
+
+        constexpr int slot_bits = 4;
+        constexpr unsigned slots_count = 1u << slot_bits;
+
+
+        unsigned slotOf(const IPAddress first, const int level)
+        {
+            return (first >> (32 - slot_bits * (level + 1))) & (slots_count - 1);
+        }
+
+
+        NodePtr makeLeaf(const Range& range)
+        {
+            auto leaf = std::make_shared<Node>();
+            leaf->range = range;
+            return leaf;
+        }
+
+
+        // Copy of internal `node` with `child` in `slot` (or with empty `slot` if `child` is null)
+        NodePtr replaceChild(const Node& node, const unsigned slot, NodePtr child)
+        {
+            auto copy = std::make_shared<Node>(node);
+            const auto index = static_cast<std::ptrdiff_t>(copy->childIndex(slot));
+            const bool had_child = (copy->slots >> slot & 1) != 0;
+            if (child && had_child)
+            {
+                copy->children[static_cast<std::size_t>(index)] = std::move(child);
+            }
+            else if (child)
+            {
+                copy->children.insert(copy->children.begin() + index, std::move(child));
+                copy->slots |= static_cast<std::uint16_t>(1u << slot);
+            }
+            else if (had_child)
+            {
+                copy->children.erase(copy->children.begin() + index);
+                copy->slots &= static_cast<std::uint16_t>(~(1u << slot));
+            }
+            return copy;
+        }
+
+
+        // Internal node of `level` (and nodes under it) for two leaves with different starts
+        NodePtr splitLeaves(NodePtr first_leaf, NodePtr second_leaf, const int level)
+        {
+            const unsigned first_slot = slotOf(first_leaf->range.first, level);
+            const unsigned second_slot = slotOf(second_leaf->range.first, level);
+            Node node;
+            if (first_slot == second_slot)
+            {
+                node.slots = static_cast<std::uint16_t>(1u << first_slot);
+                node.children.push_back(splitLeaves(std::move(first_leaf), std::move(second_leaf), level + 1));
+            }
+            else
+            {
+                node.slots = static_cast<std::uint16_t>((1u << first_slot) | (1u << second_slot));
+                if (first_slot > second_slot)
+                {
+                    std::swap(first_leaf, second_leaf);
+                }
+                node.children.push_back(std::move(first_leaf));
+                node.children.push_back(std::move(second_leaf));
+            }
+            return std::make_shared<Node>(std::move(node));
+        }
+
+
+        // `range` shouldn't start at the same address as one of ranges of `node`
+        NodePtr insertRange(const NodePtr& node, const Range& range, const int level)
+        {
+            if (!node)
+            {
+                return makeLeaf(range);
+            }
+            if (node->is_leaf())
+            {
+                assert(node->range.first != range.first);
+                return splitLeaves(node, makeLeaf(range), level);
+            }
+            const unsigned slot = slotOf(range.first, level);
+            const auto child = (node->slots >> slot & 1) != 0 ? node->children[node->childIndex(slot)] : nullptr;
+            return replaceChild(*node, slot, insertRange(child, range, level + 1));
+        }
+
+
+        // A subtree with one range is always a leaf, so that the shape depends only on starts of ranges
+        NodePtr eraseRange(const NodePtr& node, const IPAddress first, const int level)
+        {
+            assert(node);
+            if (node->is_leaf())
+            {
+                assert(node->range.first == first);
+                return nullptr;
+            }
+            const unsigned slot = slotOf(first, level);
+            auto copy = replaceChild(*node, slot, eraseRange(node->children[node->childIndex(slot)], first, level + 1));
+            if (copy->children.size() == 1 && copy->children.front()->is_leaf())
+            {
+                return copy->children.front();
+            }
+            return copy;
+        }
+
+
+        const Node* firstLeaf(const Node* node)
+        {
+            while (!node->is_leaf())
+            {
+                node = node->children.front().get();
+            }
+            return node;
+        }
+
+
+        const Node* lastLeaf(const Node* node)
+        {
+            while (!node->is_leaf())
+            {
+                node = node->children.back().get();
+            }
+            return node;
+        }
+
+
+        // The last range which starts at `address` or before it
+        std::optional<Range> findFloor(const Node* const node, const IPAddress address, const int level)
+        {
+            if (node == nullptr)
+            {
+                return std::nullopt;
+            }
+            if (node->is_leaf())
+            {
+                return node->range.first <= address ? std::optional(node->range) : std::nullopt;
+            }
+            const unsigned slot = slotOf(address, level);
+            if (const auto found = findFloor(node->child(slot), address, level + 1))
+            {
+                return found;
+            }
+            // All ranges of previous slots start before `address`
+            for (unsigned previous = slot; previous-- > 0; )
+            {
+                if (const Node* const child = node->child(previous))
+                {
+                    return lastLeaf(child)->range;
+                }
+            }
+            return std::nullopt;
+        }
+
+
+        // The first range which starts at `address` or after it
+        std::optional<Range> findCeiling(const Node* const node, const IPAddress address, const int level)
+        {
+            if (node == nullptr)
+            {
+                return std::nullopt;
+            }
+            if (node->is_leaf())
+            {
+                return node->range.first >= address ? std::optional(node->range) : std::nullopt;
+            }
+            const unsigned slot = slotOf(address, level);
+            if (const auto found = findCeiling(node->child(slot), address, level + 1))
+            {
+                return found;
+            }
+            for (unsigned next = slot + 1; next < slots_count; ++next)
+            {
+                if (const Node* const child = node->child(next))
+                {
+                    return firstLeaf(child)->range;
+                }
+            }
+            return std::nullopt;
+        }
+
+
+        template <typename Function>
+        void forEachRange(const Node* const node, Function&& function)
+        {
+            if (node->is_leaf())
+            {
+                function(node->range);
+                return;
+            }
+            for (const auto& child : node->children)
+            {
+                forEachRange(child.get(), function);
+            }
+        }
+
+
+        // Both nodes are at the same place of their tries, so their slots are the same prefixes
+        void findChangedRanges(const Node* const old_node, const Node* const new_node, std::vector<Range>& removed, std::vector<Range>& added)
+        {
+            if (old_node == new_node)
+            {
+                return;
+            }
+            if (old_node == nullptr || new_node == nullptr)
+            {
+                forEachRange(
+                    old_node != nullptr ? old_node : new_node,
+                    [&ranges = old_node != nullptr ? removed : added](const Range& range) { ranges.push_back(range); }
+                );
+                return;
+            }
+            if (old_node->is_leaf() || new_node->is_leaf())
+            {
+                // A leaf is the only range with its prefix, everything else of the other subtree is changed
+                const Range leaf_range = old_node->is_leaf() ? old_node->range : new_node->range;
+                auto& leaf_ranges = old_node->is_leaf() ? removed : added;
+                auto& other_ranges = old_node->is_leaf() ? added : removed;
+                bool found = false;
+                forEachRange(old_node->is_leaf() ? new_node : old_node, [&](const Range& range)
+                {
+                    if (range == leaf_range)
+                    {
+                        found = true;
+                    }
+                    else
+                    {
+                        other_ranges.push_back(range);
+                    }
+                });
+                if (!found)
+                {
+                    // It's the only range of this prefix on its side, so ranges stay sorted
+                    leaf_ranges.push_back(leaf_range);
+                }
+                return;
+            }
+            for (unsigned slots = old_node->slots | new_node->slots; slots != 0; slots &= slots - 1)
+            {
+                const auto slot = static_cast<unsigned>(std::countr_zero(slots));
+                findChangedRanges(old_node->child(slot), new_node->child(slot), removed, added);
+            }
+        }
+
+    } // anonymous namespace
+
+
+    PersistentPool::PersistentPool(const Pool& pool)
+    {
+        detail::ReducedRangesReader next_range(pool.cbegin(), pool.cend());
+        while (const auto range = next_range())
+        {
+            root_ = insertRange(root_, *range, 0);
+            ++size_;
+        }
+    }
+
+
+    void PersistentPool::add(const Range& range)
+    {
+        Range merged = range;
+        // The previous range, if it intersects or touches `range`
+        if (const auto previous = findFloor(root_.get(), range.first, 0); previous && std::uint64_t{previous->second} + 1 >= range.first)
+        {
+            merged = {previous->first, std::max(previous->second, range.second)};
+            root_ = eraseRange(root_, previous->first, 0);
+            --size_;
+        }
+        // Ranges which start inside of `range` or right after it
+        while (true)
+        {
+            const auto next = findCeiling(root_.get(), range.first, 0);
+            if (!next || next->first > std::uint64_t{range.second} + 1)
+            {
+                break;
+            }
+            merged.second = std::max(merged.second, next->second);
+            root_ = eraseRange(root_, next->first, 0);
+            --size_;
+        }
+        root_ = insertRange(root_, merged, 0);
+        ++size_;
+    }
+
+
+    void PersistentPool::subtract(const Range& range)
+    {
+        const auto cut = [this, &range](const Range& current)
+        {
+            root_ = eraseRange(root_, current.first, 0);
+            --size_;
+            if (current.first < range.first)
+            {
+                root_ = insertRange(root_, Range{current.first, range.first - 1}, 0);
+                ++size_;
+            }
+            if (current.second > range.second)
+            {
+                root_ = insertRange(root_, Range{range.second + 1, current.second}, 0);
+                ++size_;
+            }
+        };
+
+        if (const auto previous = findFloor(root_.get(), range.first, 0); previous && previous->second >= range.first)
+        {
+            cut(*previous);
+        }
+        while (true)
+        {
+            const auto next = findCeiling(root_.get(), range.first, 0);
+            if (!next || next->first > range.second)
+            {
+                break;
+            }
+            cut(*next);
+        }
+    }
+
+
+    bool PersistentPool::contains(const IPAddress address) const
+    {
+        const auto range = findFloor(root_.get(), address, 0);
+        return range && range->second >= address;
+    }
+
+
+    std::vector<Range> PersistentPool::ranges() const
+    {
+        std::vector<Range> ranges;
+        ranges.reserve(size_);
+        if (root_)
+        {
+            forEachRange(root_.get(), [&ranges](const Range& range) { ranges.push_back(range); });
+        }
+        return ranges;
+    }
+
+
+    Pool PersistentPool::to_pool() const
+    {
+        Pool pool;
+        if (root_)
+        {
+            forEachRange(root_.get(), [&pool](const Range& range) { pool.emplace_hint(pool.cend(), range); });
+        }
+        return pool;
+    }
+
+
+    void find_changed_ranges(
+        const PersistentPool& old_pool,
+        const PersistentPool& new_pool,
+        std::vector<Range>& removed,
+        std::vector<Range>& added
+    )
+    {
+        removed.clear();
+        added.clear();
+        findChangedRanges(old_pool.root_.get(), new_pool.root_.get(), removed, added);
+    }
+
+
+    Pool find_diff(const PersistentPool& old_pool, const PersistentPool& new_pool)
+    {
+        Pool diff;
+        find_diff(old_pool, new_pool, [&diff](const Range& range) { diff.emplace_hint(diff.cend(), range); });
+        return diff;
+    }
+
+} // namespace netup_tt
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "ipv4_pools.h"
+
+
+namespace netup_tt
+{
+
+    namespace detail
+    {
+
+        // Node of the trie of ranges, it's defined in the source file
+        struct PersistentPoolNode;
+
+    } // namespace detail
+
+
+    // Pool with cheap snapshots: copying it is O(1), and the copies share everything
+    // which hasn't been changed since. Ranges are reduced and kept in a 16-ary trie
+    // by their starts, 4 bits per level:
+    //
+    //     start      0x0A 0x00 0x01 0x00     slot on every level: 0, A, 0, 0, 0, 1, 0, 0
+    //
+    // A slot holds a range itself if it's the only one with that prefix, otherwise a node of the next level.
+    // Nodes are immutable, a change copies the path to the changed slot (at most 8 nodes) and shares the rest.
+    // The shape depends only on starts of ranges, not on the order of changes, so two snapshots
+    // have the same nodes where their ranges are the same, and `find_diff` skips such subtrees
+    // by comparing pointers: its cost depends on the number of changed ranges, not on the size of the pool.
+    //
+    //     PersistentPool pool(initial);
+    //     const PersistentPool snapshot = pool;      // O(1)
+    //     pool.subtract(Range{...});                 // `snapshot` doesn't change
+    //     const Pool released = find_diff(snapshot, pool);
+    class PersistentPool
+    {
+    public:
+        PersistentPool() = default;
+        explicit PersistentPool(const Pool& pool);
+
+        // Adds addresses of `range`, ranges stay reduced
+        void add(const Range& range);
+        // Removes addresses of `range`
+        void subtract(const Range& range);
+
+        bool contains(IPAddress address) const;
+        // Number of (reduced) ranges
+        std::size_t size() const noexcept { return size_; }
+        bool empty() const noexcept { return size_ == 0; }
+
+        // Ranges in ascending order
+        std::vector<Range> ranges() const;
+        Pool to_pool() const;
+
+        // Ranges which are in one pool and aren't in the other one (as ranges, not addresses),
+        // in ascending order. Subtrees shared by pools aren't visited.
+        friend void find_changed_ranges(
+            const PersistentPool& old_pool,
+            const PersistentPool& new_pool,
+            std::vector<Range>& removed,
+            std::vector<Range>& added
+        );
+
+    private:
+        std::shared_ptr<const detail::PersistentPoolNode> root_;
+        std::size_t size_{0};
+    };
+
+
+    // Addresses of `old_pool` which aren't in `new_pool`, reduced and in ascending order.
+    // Only changed ranges are merged: ranges are reduced, so a range which is in both pools
+    // can't intersect or touch a range which is in one of them only.
+    template <typename Sink>
+        requires std::invocable<Sink&, const Range&>
+    void find_diff(const PersistentPool& old_pool, const PersistentPool& new_pool, Sink&& sink)
+    {
+        std::vector<Range> removed;
+        std::vector<Range> added;
+        find_changed_ranges(old_pool, new_pool, removed, added);
+        detail::findDiff(
+            detail::PlainRangesReader(removed.cbegin(), removed.cend()),
+            detail::PlainRangesReader(added.cbegin(), added.cend()),
+            [&sink](const IPAddress first, const IPAddress last) { std::invoke(sink, Range{first, last}); }
+        );
+    }
+
+    Pool find_diff(const PersistentPool& old_pool, const PersistentPool& new_pool);
+
+} // namespace netup_tt
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory_resource>
+
+#include "ipv4_pools.h"
+#include "ipv6_pools.h"
+
+
+namespace netup_tt
+{
+
+    // Pools which take memory from a `std::pmr::memory_resource` instead of the global heap.
+    // With `std::pmr::monotonic_buffer_resource` nodes of a whole reconciliation (input pools
+    // and diffs) are cut out of a few big blocks, and all of them are released at once
+    // when the resource is destroyed or released:
+    //
+    //     std::pmr::monotonic_buffer_resource arena;
+    //     {
+    //         const auto diff = find_diff(old_pool, new_pool, &arena);
+    //         ...
+    //     }   // nodes aren't freed one by one, deallocation is a no-op for the arena
+    //     arena.release();
+    //
+    // With `std::pmr::unsynchronized_pool_resource` per thread, threads don't contend for the heap.
+    namespace pmr
+    {
+
+        template <typename Address>
+        using BasicPool = netup_tt::BasicPool<Address, std::pmr::polymorphic_allocator<BasicRange<Address>>>;
+
+        using Pool = BasicPool<IPAddress>;
+        using IPv6Pool = BasicPool<IPv6Address>;
+
+    } // namespace pmr
+
+
+    // Same as `find_diff` for `Pool`, but the diff is allocated from `resource`.
+    // Input pools may have any allocators (e.g. be `pmr::Pool` with another resource).
+    template <typename Address, typename OldAllocator, typename NewAllocator>
+    pmr::BasicPool<Address> find_diff(
+        const BasicPool<Address, OldAllocator>& old_pool,
+        const BasicPool<Address, NewAllocator>& new_pool,
+        std::pmr::memory_resource* const resource
+    )
+    {
+        pmr::BasicPool<Address> diff(resource);
+        find_diff(old_pool, new_pool, [&diff](const BasicRange<Address>& range) { diff.emplace_hint(diff.cend(), range); });
+        return diff;
+    }
+
+} // namespace netup_tt
@@ -0,0 +1,42 @@
+#include "pool_algebra.h"
+
+
+namespace netup_tt
+{
+
+    namespace
+    {
+
+        // Ranges are emitted in ascending order, so the end of the tree is always a correct hint
+        auto makeInserter(Pool& pool)
+        {
+            return [&pool](const Range& range) { pool.emplace_hint(pool.cend(), range); };
+        }
+
+    } // anonymous namespace
+
+
+    Pool find_union(const std::span<const Pool* const> pools)
+    {
+        Pool result;
+        find_union(pools, makeInserter(result));
+        return result;
+    }
+
+
+    Pool find_intersection(const std::span<const Pool* const> pools)
+    {
+        Pool result;
+        find_intersection(pools, makeInserter(result));
+        return result;
+    }
+
+
+    Pool find_diff(const Pool& old_pool, const std::span<const Pool* const> new_pools)
+    {
+        Pool diff;
+        find_diff(old_pool, new_pools, makeInserter(diff));
+        return diff;
+    }
+
+} // namespace netup_tt
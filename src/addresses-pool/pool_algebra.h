@@ -0,0 +1,225 @@
+#pragma once
+
+#include <cstddef>
+
+#include <algorithm>
+#include <concepts>
+#include <functional>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "ipv4_pools.h"
+
+
+namespace netup_tt
+{
+
+    namespace detail
+    {
+
+        // Restores min-heap `heap` after its top element has been replaced (with a bigger one).
+        // One sift down instead of `std::pop_heap` followed by `std::push_heap`.
+        template <typename T>
+        void siftDownTop(std::vector<T>& heap)
+        {
+            const std::size_t size = heap.size();
+            if (size == 0)
+            {
+                return;
+            }
+            T value = std::move(heap.front());
+            std::size_t index = 0;
+            while (true)
+            {
+                std::size_t child = 2 * index + 1;
+                if (child >= size)
+                {
+                    break;
+                }
+                if (child + 1 < size && heap[child + 1] < heap[child])
+                {
+                    ++child;
+                }
+                if (!(heap[child] < value))
+                {
+                    break;
+                }
+                heap[index] = std::move(heap[child]);
+                index = child;
+            }
+            heap[index] = std::move(value);
+        }
+
+
+        // Reader of the union of several readers of reduced ranges. It's a k-way merge: the next range
+        // of every reader is kept in a min-heap, ranges are taken from the heap in ascending order
+        // and glued while they intersect or touch (the same way as `extendReducedRange` does it
+        // for one sorted sequence). Every range costs O(log k), where k is the number of readers.
+        template <typename Reader>
+        class UnionReader
+        {
+        public:
+            using RangeType = ReaderRange<Reader>;
+
+            explicit UnionReader(std::vector<Reader> readers)
+                : readers_(std::move(readers))
+            {
+                heads_.reserve(readers_.size());
+                for (std::size_t index = 0; index < readers_.size(); ++index)
+                {
+                    if (const auto range = readers_[index]())
+                    {
+                        heads_.emplace_back(*range, index);
+                    }
+                }
+                std::make_heap(heads_.begin(), heads_.end(), std::greater<>());
+            }
+
+            std::optional<RangeType> operator()()
+            {
+                if (heads_.empty())
+                {
+                    return std::nullopt;
+                }
+                RangeType range = popHead();
+                while (!heads_.empty() && !isSeparated(range, heads_.front().first.first))
+                {
+                    range.second = std::max(range.second, popHead().second);
+                }
+                return range;
+            }
+
+        private:
+            // Takes the smallest head and puts the next range of its reader instead of it
+            RangeType popHead()
+            {
+                auto& [range, index] = heads_.front();
+                const RangeType result = range;
+                if (const auto next = readers_[index]())
+                {
+                    range = *next;
+                }
+                else
+                {
+                    heads_.front() = heads_.back();
+                    heads_.pop_back();
+                }
+                siftDownTop(heads_);
+                return result;
+            }
+
+            std::vector<Reader> readers_;
+            // The next range of every reader which isn't over, with the reader's index
+            std::vector<std::pair<RangeType, std::size_t>> heads_;
+        };
+
+
+        // Calls `emit(first, last)` for every range of the intersection of reduced ranges of `readers`
+        // in ascending order. Current ranges of all readers intersect in [the biggest start, the smallest end];
+        // the reader whose range ends first is advanced, ends are kept in a min-heap.
+        // Emitted ranges are reduced: the next one starts after the start of a range of the advanced
+        // reader, which isn't adjacent to the previous range of that reader.
+        template <typename Reader, typename Emit>
+        void findIntersection(std::vector<Reader> readers, Emit&& emit)
+        {
+            using Address = ReaderAddress<Reader>;
+
+            if (readers.empty())
+            {
+                return;
+            }
+            std::vector<std::pair<Address, std::size_t>> lasts;
+            lasts.reserve(readers.size());
+            Address max_first{};
+            for (std::size_t index = 0; index < readers.size(); ++index)
+            {
+                const auto range = readers[index]();
+                if (!range)
+                {
+                    return;
+                }
+                max_first = std::max(max_first, range->first);
+                lasts.emplace_back(range->second, index);
+            }
+            std::make_heap(lasts.begin(), lasts.end(), std::greater<>());
+
+            while (true)
+            {
+                auto& [min_last, index] = lasts.front();
+                if (max_first <= min_last)
+                {
+                    emit(max_first, min_last);
+                }
+                const auto next = readers[index]();
+                if (!next)
+                {
+                    return;
+                }
+                // Start of the replaced range is before `next->first`, so it can't be the only biggest one
+                max_first = std::max(max_first, next->first);
+                min_last = next->second;
+                siftDownTop(lasts);
+            }
+        }
+
+
+        inline auto makeRangesReaders(const std::span<const Pool* const> pools)
+        {
+            std::vector<ReducedRangesReader<Pool::const_iterator>> readers;
+            readers.reserve(pools.size());
+            for (const Pool* const pool : pools)
+            {
+                readers.emplace_back(pool->cbegin(), pool->cend());
+            }
+            return readers;
+        }
+
+    } // namespace detail
+
+
+    // Set operations over any number of pools, each one is a single k-way sweep over all pools
+    // with nothing materialized in between. Pools are passed by pointers, so that pools
+    // kept anywhere may be combined without copying. Ranges of results are reduced and ascending.
+
+    // Union of all `pools`, empty if there are no pools
+    template <typename Sink>
+        requires std::invocable<Sink&, const Range&>
+    void find_union(const std::span<const Pool* const> pools, Sink&& sink)
+    {
+        detail::UnionReader next_range(detail::makeRangesReaders(pools));
+        while (const auto range = next_range())
+        {
+            std::invoke(sink, *range);
+        }
+    }
+
+    // Intersection of all `pools`, empty if there are no pools
+    template <typename Sink>
+        requires std::invocable<Sink&, const Range&>
+    void find_intersection(const std::span<const Pool* const> pools, Sink&& sink)
+    {
+        detail::findIntersection(
+            detail::makeRangesReaders(pools),
+            [&sink](const IPAddress first, const IPAddress last) { std::invoke(sink, Range{first, last}); }
+        );
+    }
+
+    // `old_pool \ (new_pools[0] ∪ new_pools[1] ∪ ...)`, i.e. addresses of `old_pool` which aren't in any of `new_pools`
+    template <typename Sink>
+        requires std::invocable<Sink&, const Range&>
+    void find_diff(const Pool& old_pool, const std::span<const Pool* const> new_pools, Sink&& sink)
+    {
+        detail::findDiff(
+            detail::ReducedRangesReader(old_pool.cbegin(), old_pool.cend()),
+            detail::UnionReader(detail::makeRangesReaders(new_pools)),
+            [&sink](const IPAddress first, const IPAddress last) { std::invoke(sink, Range{first, last}); }
+        );
+    }
+
+    Pool find_union(std::span<const Pool* const> pools);
+    Pool find_intersection(std::span<const Pool* const> pools);
+    Pool find_diff(const Pool& old_pool, std::span<const Pool* const> new_pools);
+
+} // namespace netup_tt
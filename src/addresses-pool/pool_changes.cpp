@@ -0,0 +1,29 @@
+#include "pool_changes.h"
+
+
+namespace netup_tt
+{
+
+    PoolChanges find_changes(const Pool& old_pool, const Pool& new_pool, const bool with_unchanged)
+    {
+        PoolChanges changes;
+
+        // Ranges are emitted in ascending order, so the end of the tree is always a correct hint
+        find_changes(
+            old_pool,
+            new_pool,
+            [&changes](const Range& range) { changes.removed.emplace_hint(changes.removed.cend(), range); },
+            [&changes](const Range& range) { changes.added.emplace_hint(changes.added.cend(), range); },
+            [&changes, with_unchanged](const Range& range)
+            {
+                if (with_unchanged)
+                {
+                    changes.unchanged.emplace_hint(changes.unchanged.cend(), range);
+                }
+            }
+        );
+
+        return changes;
+    }
+
+} // namespace netup_tt
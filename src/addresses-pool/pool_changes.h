@@ -0,0 +1,56 @@
+#pragma once
+
+#include <concepts>
+#include <functional>
+
+#include "ipv4_pools.h"
+#include "normalized_pool.h"
+
+
+namespace netup_tt
+{
+
+    struct PoolChanges
+    {
+        // Same as `find_diff(old_pool, new_pool)`
+        Pool removed;
+        // Same as `find_diff(new_pool, old_pool)`
+        Pool added;
+        // Intersection of pools, filled only on request
+        Pool unchanged;
+    };
+
+
+    // Finds both directions of diff between pools (and, optionally, their intersection)
+    // in one merge over them, so every pool is walked and reduced only once.
+    PoolChanges find_changes(const Pool& old_pool, const Pool& new_pool, bool with_unchanged = false);
+
+
+    // Streaming version: ranges are passed to sinks in ascending order as soon as they are found.
+    // Pools may be `Pool`, `FlatPool` or `NormalizedPool` in any combination.
+    template <
+        typename OldPool, typename NewPool,
+        typename RemovedSink, typename AddedSink, typename UnchangedSink
+    >
+        requires detail::AnyPool<OldPool> && detail::AnyPool<NewPool>
+            && std::invocable<RemovedSink&, const Range&>
+            && std::invocable<AddedSink&, const Range&>
+            && std::invocable<UnchangedSink&, const Range&>
+    void find_changes(
+        const OldPool& old_pool,
+        const NewPool& new_pool,
+        RemovedSink&& removed_sink,
+        AddedSink&& added_sink,
+        UnchangedSink&& unchanged_sink
+    )
+    {
+        detail::findChanges(
+            detail::makeRangesReader(old_pool),
+            detail::makeRangesReader(new_pool),
+            [&removed_sink](const IPAddress first, const IPAddress last) { std::invoke(removed_sink, Range{first, last}); },
+            [&added_sink](const IPAddress first, const IPAddress last) { std::invoke(added_sink, Range{first, last}); },
+            [&unchanged_sink](const IPAddress first, const IPAddress last) { std::invoke(unchanged_sink, Range{first, last}); }
+        );
+    }
+
+} // namespace netup_tt
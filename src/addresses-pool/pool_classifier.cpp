@@ -0,0 +1,178 @@
+#include "pool_classifier.h"
+
+#include <bit>
+#include <stdexcept>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define NETUP_TT_HAS_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
+
+namespace netup_tt
+{
+
+    namespace
+    {
+
+        using Node = PoolClassifier::Node;
+
+        constexpr std::size_t node_keys = PoolClassifier::node_keys;
+
+
+        // Children of node `k` are `k * (node_keys + 1) + 1` ... `k * (node_keys + 1) + node_keys + 1`,
+        // child `i` holds keys which go between keys `i - 1` and `i` of node `k`
+        std::size_t childNode(const std::size_t node, const std::size_t child) noexcept
+        {
+            return node * (node_keys + 1) + child + 1;
+        }
+
+
+        // The first range which ends at `address` or after it contains `address` if it starts before it
+        std::uint32_t checkFound(const std::vector<Range>& ranges, const std::uint32_t found, const IPAddress address) noexcept
+        {
+            return found != PoolClassifier::not_found && ranges[found].first <= address ? found : PoolClassifier::not_found;
+        }
+
+
+        // How many keys of a node are less than `address`, that's the child to go to
+        std::size_t countLessScalar(const Node& node, const IPAddress address) noexcept
+        {
+            std::size_t less = 0;
+            for (const auto last : node.lasts)
+            {
+                less += last < address;
+            }
+            return less;
+        }
+
+
+        // Search for the first range which ends at `address` or after it.
+        // Kernels repeat this loop, so that the node search is inlined into it
+        std::uint32_t classifyScalar(const std::vector<Node>& nodes, const std::vector<Range>& ranges, const IPAddress address) noexcept
+        {
+            std::uint32_t found = PoolClassifier::not_found;
+            for (std::size_t node = 0; node < nodes.size(); )
+            {
+                const std::size_t less = countLessScalar(nodes[node], address);
+                found = less < node_keys ? nodes[node].range_indexes[less] : found;
+                node = childNode(node, less);
+            }
+            return checkFound(ranges, found, address);
+        }
+
+
+#ifdef NETUP_TT_HAS_AVX2_KERNEL
+
+        // AVX2 has signed comparisons only, flipping the sign bit makes them unsigned
+        __attribute__((target("avx2")))
+        std::size_t countLessAvx2(const Node& node, const IPAddress address) noexcept
+        {
+            const __m256i sign_bit = _mm256_set1_epi32(std::numeric_limits<std::int32_t>::min());
+            const __m256i biased_address = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(address)), sign_bit);
+            const auto* const keys = reinterpret_cast<const __m256i*>(node.lasts.data());
+            const __m256i low_less = _mm256_cmpgt_epi32(biased_address, _mm256_xor_si256(_mm256_load_si256(keys), sign_bit));
+            const __m256i high_less = _mm256_cmpgt_epi32(biased_address, _mm256_xor_si256(_mm256_load_si256(keys + 1), sign_bit));
+            const auto mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(low_less)))
+                | static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(high_less))) << 8;
+            return static_cast<std::size_t>(std::popcount(mask));
+        }
+
+
+        __attribute__((target("avx2")))
+        void classifyAvx2(
+            const std::vector<Node>& nodes,
+            const std::vector<Range>& ranges,
+            const std::span<const IPAddress> addresses,
+            const std::span<std::uint32_t> range_indexes
+        ) noexcept
+        {
+            for (std::size_t i = 0; i < addresses.size(); ++i)
+            {
+                std::uint32_t found = PoolClassifier::not_found;
+                for (std::size_t node = 0; node < nodes.size(); )
+                {
+                    const std::size_t less = countLessAvx2(nodes[node], addresses[i]);
+                    found = less < node_keys ? nodes[node].range_indexes[less] : found;
+                    node = childNode(node, less);
+                }
+                range_indexes[i] = checkFound(ranges, found, addresses[i]);
+            }
+        }
+
+#endif
+
+    } // anonymous namespace
+
+
+    PoolClassifier::PoolClassifier(const Pool& pool)
+        : PoolClassifier(NormalizedPool(pool))
+    {
+    }
+
+
+    PoolClassifier::PoolClassifier(const NormalizedPool& pool)
+        : ranges_(pool.ranges())
+        , nodes_((ranges_.size() + node_keys - 1) / node_keys)
+    {
+        fillNodes(0, 0);
+    }
+
+
+    std::size_t PoolClassifier::fillNodes(const std::size_t node, std::size_t next_range)
+    {
+        // In-order walk over the tree puts sorted ranges into their places
+        if (node >= nodes_.size())
+        {
+            return next_range;
+        }
+        for (std::size_t key = 0; key < node_keys; ++key)
+        {
+            next_range = fillNodes(childNode(node, key), next_range);
+            const bool is_used = next_range < ranges_.size();
+            nodes_[node].lasts[key] = is_used ? ranges_[next_range].second : std::numeric_limits<IPAddress>::max();
+            nodes_[node].range_indexes[key] = is_used ? static_cast<std::uint32_t>(next_range) : not_found;
+            next_range += is_used ? 1 : 0;
+        }
+        return fillNodes(childNode(node, node_keys), next_range);
+    }
+
+
+    void PoolClassifier::classify(
+        const std::span<const IPAddress> addresses,
+        const std::span<std::uint32_t> range_indexes,
+        const Kernel kernel
+    ) const
+    {
+        if (range_indexes.size() < addresses.size())
+        {
+            throw std::invalid_argument("PoolClassifier::classify: range_indexes is smaller than addresses");
+        }
+
+#ifdef NETUP_TT_HAS_AVX2_KERNEL
+        if (kernel != Kernel::scalar && is_avx2_supported())
+        {
+            classifyAvx2(nodes_, ranges_, addresses, range_indexes);
+            return;
+        }
+#else
+        static_cast<void>(kernel);
+#endif
+        for (std::size_t i = 0; i < addresses.size(); ++i)
+        {
+            range_indexes[i] = classifyScalar(nodes_, ranges_, addresses[i]);
+        }
+    }
+
+
+    bool PoolClassifier::is_avx2_supported() noexcept
+    {
+#ifdef NETUP_TT_HAS_AVX2_KERNEL
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+} // namespace netup_tt
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "ipv4_pools.h"
+#include "normalized_pool.h"
+
+
+namespace netup_tt
+{
+
+    // Finds which range of a pool every address of a batch belongs to.
+    // Made for small and medium pools (up to several thousand ranges): ends of reduced ranges
+    // are laid out as a static B-tree with 16 keys per node, keys of a node take one cache line.
+    // Every node is passed by comparing an address with all 16 keys at once (two AVX2 comparisons),
+    // so a pool of 4096 ranges takes 3 steps per address instead of 12 steps of binary search.
+    //
+    //                        [ 16 keys ]
+    //                     /   /   ...   |    |
+    //             [ 16 keys ] [ 16 keys ] ... [ 16 keys ]       17 children per node
+    //
+    // AVX2 is used if the CPU supports it (checked at runtime), otherwise nodes are searched by scalar code.
+    class PoolClassifier
+    {
+    public:
+        // Written for addresses which aren't in the pool
+        static constexpr std::uint32_t not_found = std::numeric_limits<std::uint32_t>::max();
+
+        enum class Kernel
+        {
+            // The best one supported by the CPU
+            automatic,
+            scalar,
+            // Falls back to `scalar` if the CPU doesn't support it
+            avx2
+        };
+
+        PoolClassifier() = default;
+        explicit PoolClassifier(const Pool& pool);
+        explicit PoolClassifier(const NormalizedPool& pool);
+
+        // Writes to `range_indexes[i]` index of the range (in `ranges()`) which contains `addresses[i]`,
+        // or `not_found`. `range_indexes` should be at least as big as `addresses`,
+        // otherwise `std::invalid_argument` is thrown.
+        void classify(
+            std::span<const IPAddress> addresses,
+            std::span<std::uint32_t> range_indexes,
+            Kernel kernel = Kernel::automatic
+        ) const;
+
+        // Reduced ranges of the pool, in ascending order
+        const std::vector<Range>& ranges() const noexcept { return ranges_; }
+        std::size_t size() const noexcept { return ranges_.size(); }
+        bool empty() const noexcept { return ranges_.empty(); }
+
+        static bool is_avx2_supported() noexcept;
+
+        static constexpr std::size_t node_keys = 16;
+
+        // Keys are ends of ranges. Slots which are left over in the last nodes have
+        // the biggest key and `not_found` index, so they are never chosen instead of real ranges.
+        struct alignas(64) Node
+        {
+            std::array<IPAddress, node_keys> lasts;
+            std::array<std::uint32_t, node_keys> range_indexes;
+        };
+
+    private:
+        std::size_t fillNodes(std::size_t node, std::size_t next_range);
+
+        std::vector<Range> ranges_;
+        std::vector<Node> nodes_;
+    };
+
+} // namespace netup_tt
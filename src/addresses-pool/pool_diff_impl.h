@@ -0,0 +1,491 @@
+#pragma once
+
+// Shouldn't be included directly, include "ipv4_pools.h" instead
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+
+
+// Implementation details shared by all `find_diff` overloads.
+// Algorithms are written in terms of readers of sorted reduced ranges,
+// so the same code works for `Pool` (tree), for flat containers and for their parts.
+// Type of ranges is taken from readers and iterators, so nothing here depends on the width
+// of addresses: any unsigned type with `+`, `-` and comparisons fits (e.g. `IPv6Address`).
+// Readers and `findDiff` are constexpr, so diffs of fixed tables are found at compile time too
+// (see "static_pool.h").
+namespace netup_tt
+{
+
+    namespace detail
+    {
+
+        // Range type of a reader
+        template <typename Reader>
+        using ReaderRange = typename std::invoke_result_t<Reader&>::value_type;
+
+        template <typename Reader>
+        using ReaderAddress = typename ReaderRange<Reader>::first_type;
+
+
+        // True if a range which starts at `next_first` (not before `range`)
+        // neither intersects `range` nor is adjacent to it
+        template <typename RangeType>
+        constexpr bool isSeparated(const RangeType& range, const typename RangeType::first_type& next_first)
+        {
+            // Simpler condition like `range.second + 1 < next_first`
+            // doesn't work well when `range.second` equals to maximal value of address type
+            return next_first > range.second && next_first - range.second > 1;
+        }
+
+
+        // Merges into `range` all following ranges which intersect it or are adjacent to it.
+        // Ranges in [current, end) should be sorted and shouldn't start before `range`.
+        template <typename RangeType, typename Iterator>
+        constexpr void extendReducedRange(
+            RangeType& range,
+            Iterator& current,
+            const Iterator end
+        )
+        {
+            for (; current != end; ++current)
+            {
+                if (isSeparated(range, current->first))
+                {
+                    break;
+                }
+                range.second = std::max(range.second, current->second);
+            }
+        }
+
+
+        template <typename Iterator>
+        constexpr std::optional<std::iter_value_t<Iterator>> getNextReducedRange(
+            Iterator& current,
+            const Iterator end
+        )
+        {
+            if (current == end)
+            {
+                return std::nullopt;
+            }
+
+            std::iter_value_t<Iterator> range = *current;
+            extendReducedRange(range, ++current, end);
+            return range;
+        }
+
+
+        // Source of reduced ranges for `findDiff`: every call returns next reduced range
+        // of sorted ranges in [begin, end), or `std::nullopt` when they are over.
+        template <typename Iterator>
+        class ReducedRangesReader
+        {
+        public:
+            constexpr ReducedRangesReader(const Iterator begin, const Iterator end)
+                : current_(begin)
+                , end_(end)
+            {
+            }
+
+            constexpr std::optional<std::iter_value_t<Iterator>> operator()()
+            {
+                return getNextReducedRange(current_, end_);
+            }
+
+        private:
+            Iterator current_;
+            Iterator end_;
+        };
+
+
+        // Same as `ReducedRangesReader`, but for ranges which are already reduced:
+        // they are returned as they are, without looking for intersections.
+        template <typename Iterator>
+        class PlainRangesReader
+        {
+        public:
+            constexpr PlainRangesReader(const Iterator begin, const Iterator end)
+                : current_(begin)
+                , end_(end)
+            {
+            }
+
+            constexpr std::optional<std::iter_value_t<Iterator>> operator()()
+            {
+                if (current_ == end_)
+                {
+                    return std::nullopt;
+                }
+                return *current_++;
+            }
+
+        private:
+            Iterator current_;
+            Iterator end_;
+        };
+
+
+        // Calls `emit(first, last)` for every range of `old \ new` in ascending order.
+        // Emitted ranges are reduced: they don't intersect and aren't adjacent.
+        // `next_old` and `next_new` are readers of reduced ranges (like `ReducedRangesReader`).
+        template <typename OldReader, typename NewReader, typename Emit>
+        constexpr void findDiff(OldReader&& next_old, NewReader&& next_new, Emit&& emit)
+        {
+            std::optional<ReaderRange<OldReader>> old_range;
+            std::optional<ReaderRange<NewReader>> new_range;
+            bool advance_old{true}, advance_new{true};
+            std::optional<ReaderAddress<OldReader>> noncovered_start;
+
+            while (true)
+            {
+                if (advance_old)
+                {
+                    old_range = next_old();
+                    if (old_range)
+                    {
+                        noncovered_start = old_range->first;
+                    }
+                    else
+                    {
+                        noncovered_start.reset();
+                    }
+                    advance_old = false;
+                }
+
+                if (advance_new)
+                {
+                    new_range = next_new();
+                    advance_new = false;
+                }
+
+                if (!old_range || !new_range)
+                {
+                    break;
+                }
+
+                if (old_range->second < new_range->first)
+                {
+                    // Current `old_range` is strictly before current `new_range`.
+
+                    if (noncovered_start)
+                    {
+                        // Example 1:
+                        //                  v <- noncovered_start
+                        // old: -----[a b c d e]-----------------
+                        // new: -[0 1 a b c]--------[k l m n o]----
+                        //                          ^ current new_range
+                        // => should add [de] to diff
+                        // Example 2:
+                        //          v <- noncovered_start
+                        // old: ---[a b c d e]-----------------
+                        // new: ----------------[k l m n o]----
+                        //                      ^ current new_range
+                        // => should add [a..e] to diff
+                        emit(*noncovered_start, old_range->second);
+                        noncovered_start.reset();
+                    }
+                    advance_old = true;
+                }
+                else if (new_range->second < old_range->first)
+                {
+                    // Current `new_range` is strictly before current `old_range`.
+                    // For example,
+                    // old: ----------------[k l m n o]----
+                    // new: ---[a b c d e]-----------------
+                    advance_new = true;
+                }
+                else
+                {
+                    // Current `new_range` and current `old_range` have nonempty intersection
+
+                    if (noncovered_start)
+                    {
+                        // Let's add noncovered part.
+                        // Example 1:
+                        //                        v <- noncovered_start
+                        // old: ---[a b c d e f g h i j k l m n o p]---------------
+                        // new: -------[c d e f g]-----[k l m n o p q r s ...]-----
+                        //                              ^ current new_range
+                        // => should add [h i j] to diff
+                        // Example 2:
+                        //          v <- noncovered_start
+                        // old: ---[a b c d e f g h i j k l m n o p]-----
+                        // new: -------[c d e f g]-----[...]-------------
+                        //             ^ current new_range
+                        // => should add [a b] to diff
+                        if (*noncovered_start < new_range->first)
+                        {
+                            emit(*noncovered_start, new_range->first - 1);
+                        }
+                        noncovered_start.reset();
+                    }
+
+                    if (new_range->second < old_range->second)
+                    {
+                        // Example 1:
+                        // old: ---[a b c d e f g h i j k l m n o p]-----
+                        // new: -------[c d e f g]-----[...]-------------
+                        //             ^ current new_range
+                        // => should mark h as noncovered_start
+                        //
+                        // Example 2:
+                        // old: ------[c d e f g h ...]------------
+                        // new: --[a b c d e]------[.........]-----
+                        // => should mark "f" as noncovered_start
+                        noncovered_start = new_range->second + 1;
+                        advance_new = true;
+                    }
+                    else
+                    {
+                        // Example 1:
+                        // old: ---[a b c d e]-----------
+                        // new: -------[c d e f g h]-----
+                        //
+                        // Example 2:
+                        // old: --------[c d e f g h]----[. . .]-------------
+                        // new: ----[a b c d e f g h i j k l m n o ...]------
+                        advance_old = true;
+                    }
+                }
+            }
+
+            // At this point we may reach end of `new_pool`, but there may be unhandled
+            // ranges in `old_pool`. Let's add them
+            if (noncovered_start)
+            {
+                emit(*noncovered_start, old_range->second);
+            }
+            // parentheses around assignment to `old_range` added to silence clang warning
+            while ((old_range = next_old()))
+            {
+                emit(old_range->first, old_range->second);
+            }
+        }
+
+
+        // Symmetric version of `findDiff`: in one merge of reduced ranges of both pools
+        // calls `emit_removed` for ranges of `old \ new`, `emit_added` for ranges of `new \ old`
+        // and `emit_unchanged` for ranges of their intersection. Every kind of ranges is emitted
+        // in ascending order and is reduced (exactly like `findDiff` does it).
+        template <
+            typename OldReader, typename NewReader,
+            typename EmitRemoved, typename EmitAdded, typename EmitUnchanged
+        >
+        void findChanges(
+            OldReader&& next_old,
+            NewReader&& next_new,
+            EmitRemoved&& emit_removed,
+            EmitAdded&& emit_added,
+            EmitUnchanged&& emit_unchanged
+        )
+        {
+            // Parts of ranges which are already handled are cut off from their beginnings
+            std::optional<ReaderRange<OldReader>> old_range = next_old();
+            std::optional<ReaderRange<NewReader>> new_range = next_new();
+
+            while (old_range && new_range)
+            {
+                if (old_range->second < new_range->first)
+                {
+                    // old: ---[a b c]--------------
+                    // new: -------------[k l m]----
+                    emit_removed(old_range->first, old_range->second);
+                    old_range = next_old();
+                }
+                else if (new_range->second < old_range->first)
+                {
+                    // old: -------------[k l m]----
+                    // new: ---[a b c]--------------
+                    emit_added(new_range->first, new_range->second);
+                    new_range = next_new();
+                }
+                else if (old_range->first < new_range->first)
+                {
+                    // old: ---[a b c d e]----------
+                    // new: -------[c d e f g]------
+                    // => [a b] is removed, the rest of old range is handled with the same new range
+                    emit_removed(old_range->first, new_range->first - 1);
+                    old_range->first = new_range->first;
+                }
+                else if (new_range->first < old_range->first)
+                {
+                    emit_added(new_range->first, old_range->first - 1);
+                    new_range->first = old_range->first;
+                }
+                else
+                {
+                    // Both ranges start at the same address, their common part is unchanged.
+                    // The longer range goes on after it
+                    const auto common_last = std::min(old_range->second, new_range->second);
+                    emit_unchanged(old_range->first, common_last);
+
+                    if (old_range->second == common_last)
+                    {
+                        old_range = next_old();
+                    }
+                    else
+                    {
+                        old_range->first = common_last + 1;
+                    }
+
+                    if (new_range->second == common_last)
+                    {
+                        new_range = next_new();
+                    }
+                    else
+                    {
+                        new_range->first = common_last + 1;
+                    }
+                }
+            }
+
+            for (; old_range; old_range = next_old())
+            {
+                emit_removed(old_range->first, old_range->second);
+            }
+            for (; new_range; new_range = next_new())
+            {
+                emit_added(new_range->first, new_range->second);
+            }
+        }
+
+
+        // If one pool is this many times bigger than the other one, it's cheaper
+        // to search through the bigger pool than to walk over all of its ranges
+        inline constexpr std::size_t galloping_min_ratio = 32;
+
+        inline bool isWorthGalloping(const std::size_t bigger_size, const std::size_t smaller_size)
+        {
+            return bigger_size / galloping_min_ratio > smaller_size;
+        }
+
+
+        // Exponential search: returns the first iterator in [begin, end) for which `pred` is false
+        // (`pred` should partition the range). Costs O(log d), where d is distance to the result.
+        template <typename RandomAccessIterator, typename Predicate>
+        RandomAccessIterator gallop(
+            const RandomAccessIterator begin,
+            const RandomAccessIterator end,
+            Predicate pred
+        )
+        {
+            const auto size = static_cast<std::size_t>(std::distance(begin, end));
+            std::size_t bound = 1;
+            if (size == 0 || !pred(*begin))
+            {
+                return begin;
+            }
+            while (bound < size && pred(begin[static_cast<std::ptrdiff_t>(bound)]))
+            {
+                bound *= 2;
+            }
+            return std::partition_point(
+                begin + static_cast<std::ptrdiff_t>(bound / 2 + 1),
+                begin + static_cast<std::ptrdiff_t>(std::min(bound, size)),
+                pred
+            );
+        }
+
+
+        // Same as `findDiff`, but for the case when new ranges [new_iter, new_end) are already reduced
+        // and there are much more of them than of old ones. For every old range, new ranges
+        // before it are skipped by galloping, so only new ranges intersecting old ones are visited.
+        template <typename OldReader, typename RandomAccessIterator, typename Emit>
+        void findDiffGallopingNew(
+            OldReader&& next_old,
+            RandomAccessIterator new_iter,
+            const RandomAccessIterator new_end,
+            Emit&& emit
+        )
+        {
+            while (const auto old_range = next_old())
+            {
+                new_iter = gallop(new_iter, new_end, [&old_range](const auto& range)
+                {
+                    return range.second < old_range->first;
+                });
+
+                auto noncovered_start = old_range->first;
+                bool is_covered_till_end = false;
+                for (; new_iter != new_end && new_iter->first <= old_range->second; ++new_iter)
+                {
+                    if (noncovered_start < new_iter->first)
+                    {
+                        emit(noncovered_start, new_iter->first - 1);
+                    }
+                    if (new_iter->second >= old_range->second)
+                    {
+                        // Current new range may cover the next old range too, so it's not skipped
+                        is_covered_till_end = true;
+                        break;
+                    }
+                    noncovered_start = new_iter->second + 1;
+                }
+                if (!is_covered_till_end)
+                {
+                    emit(noncovered_start, old_range->second);
+                }
+            }
+        }
+
+
+        // Same as `findDiff`, but for the case when old ranges [old_iter, old_end) are already reduced
+        // and there are much more of them than of new ones. For every new range, the old ranges
+        // before it get into diff as they are, and the first old range touching it is found by galloping.
+        template <typename RandomAccessIterator, typename NewReader, typename Emit>
+        void findDiffGallopingOld(
+            RandomAccessIterator old_iter,
+            const RandomAccessIterator old_end,
+            NewReader&& next_new,
+            Emit&& emit
+        )
+        {
+            // Start of the part of `*old_iter` which isn't handled yet, if the range is cut by a new one
+            std::optional<typename std::iter_value_t<RandomAccessIterator>::first_type> noncovered_start;
+            const auto emit_untouched = [&](const RandomAccessIterator untouched_end)
+            {
+                for (; old_iter != untouched_end; ++old_iter)
+                {
+                    emit(noncovered_start.value_or(old_iter->first), old_iter->second);
+                    noncovered_start.reset();
+                }
+            };
+
+            while (old_iter != old_end)
+            {
+                const auto new_range = next_new();
+                if (!new_range)
+                {
+                    break;
+                }
+
+                emit_untouched(gallop(old_iter, old_end, [&new_range](const auto& range)
+                {
+                    return range.second < new_range->first;
+                }));
+
+                for (; old_iter != old_end && old_iter->first <= new_range->second; ++old_iter)
+                {
+                    const auto start = noncovered_start.value_or(old_iter->first);
+                    if (start < new_range->first)
+                    {
+                        emit(start, new_range->first - 1);
+                    }
+                    if (old_iter->second > new_range->second)
+                    {
+                        noncovered_start = new_range->second + 1;
+                        break;
+                    }
+                    noncovered_start.reset();
+                }
+            }
+
+            emit_untouched(old_end);
+        }
+
+    } // namespace detail
+
+} // namespace netup_tt
@@ -0,0 +1,285 @@
+#include "pool_diff_tracker.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+
+namespace netup_tt
+{
+
+    namespace
+    {
+
+        using Coverage = std::map<IPAddress, std::size_t>;
+
+        constexpr auto upper_limit = std::numeric_limits<IPAddress>::max();
+
+
+        Coverage makeCoverage(const Pool& pool)
+        {
+            // Sweep over starts and ends of ranges (an end is the address after the range)
+            std::vector<std::pair<IPAddress, std::int64_t>> events;
+            events.reserve(2 * pool.size());
+            for (const auto& range : pool)
+            {
+                events.emplace_back(range.first, 1);
+                if (range.second != upper_limit)
+                {
+                    events.emplace_back(range.second + 1, -1);
+                }
+            }
+            std::sort(events.begin(), events.end());
+
+            Coverage coverage{{0, 0}};
+            std::int64_t count = 0;
+            for (auto iter = events.cbegin(); iter != events.cend(); )
+            {
+                const IPAddress address = iter->first;
+                for (; iter != events.cend() && iter->first == address; ++iter)
+                {
+                    count += iter->second;
+                }
+                const auto segment_count = static_cast<std::size_t>(count);
+                if (address == 0)
+                {
+                    coverage.begin()->second = segment_count;
+                }
+                else if (std::prev(coverage.cend())->second != segment_count)
+                {
+                    coverage.emplace_hint(coverage.cend(), address, segment_count);
+                }
+            }
+            return coverage;
+        }
+
+
+        Coverage::const_iterator findSegment(const Coverage& coverage, const IPAddress address)
+        {
+            return std::prev(coverage.upper_bound(address));
+        }
+
+
+        // Makes `address` the start of a segment
+        Coverage::iterator splitSegment(Coverage& coverage, const IPAddress address)
+        {
+            const auto next = coverage.upper_bound(address);
+            const auto current = std::prev(next);
+            if (current->first == address)
+            {
+                return current;
+            }
+            return coverage.emplace_hint(next, address, current->second);
+        }
+
+
+        // Segment `iter` is merged into the previous one if they have the same coverage
+        void mergeWithPrevious(Coverage& coverage, const Coverage::iterator iter)
+        {
+            if (iter != coverage.begin() && iter != coverage.end() && std::prev(iter)->second == iter->second)
+            {
+                coverage.erase(iter);
+            }
+        }
+
+
+        void changeCoverage(Coverage& coverage, const Range& range, const bool is_added)
+        {
+            const auto begin = splitSegment(coverage, range.first);
+            const auto end = range.second == upper_limit ? coverage.end() : splitSegment(coverage, range.second + 1);
+            for (auto iter = begin; iter != end; ++iter)
+            {
+                is_added ? ++iter->second : --iter->second;
+            }
+            // Segments inside the range had different coverage and still do, only the edges may be merged
+            mergeWithPrevious(coverage, end);
+            mergeWithPrevious(coverage, begin);
+        }
+
+
+        // Collects consecutive diff ranges into `diff`, gluing adjacent ones
+        class DiffBuilder
+        {
+        public:
+            explicit DiffBuilder(Pool& diff)
+                : diff_(diff)
+            {
+            }
+
+            void add(const IPAddress first, const IPAddress last)
+            {
+                if (pending_ && pending_->second != upper_limit && pending_->second + 1 == first)
+                {
+                    pending_->second = last;
+                    return;
+                }
+                flush();
+                pending_ = Range{first, last};
+            }
+
+            void flush()
+            {
+                if (pending_)
+                {
+                    diff_.insert(*pending_);
+                    pending_.reset();
+                }
+            }
+
+        private:
+            Pool& diff_;
+            std::optional<Range> pending_;
+        };
+
+    } // anonymous namespace
+
+
+    PoolDiffTracker::PoolDiffTracker()
+        : old_coverage_{{0, 0}}
+        , new_coverage_{{0, 0}}
+    {
+    }
+
+
+    PoolDiffTracker::PoolDiffTracker(Pool old_pool, Pool new_pool)
+        : old_pool_(std::move(old_pool))
+        , new_pool_(std::move(new_pool))
+        , old_coverage_(makeCoverage(old_pool_))
+        , new_coverage_(makeCoverage(new_pool_))
+        , diff_(find_diff(old_pool_, new_pool_))
+    {
+    }
+
+
+    bool PoolDiffTracker::insert_old(const Range& range)
+    {
+        if (!old_pool_.insert(range).second)
+        {
+            return false;
+        }
+        changeCoverage(old_coverage_, range, true);
+        updateDiff(range);
+        return true;
+    }
+
+
+    bool PoolDiffTracker::insert_new(const Range& range)
+    {
+        if (!new_pool_.insert(range).second)
+        {
+            return false;
+        }
+        changeCoverage(new_coverage_, range, true);
+        updateDiff(range);
+        return true;
+    }
+
+
+    bool PoolDiffTracker::erase_old(const Range& range)
+    {
+        if (old_pool_.erase(range) == 0)
+        {
+            return false;
+        }
+        changeCoverage(old_coverage_, range, false);
+        updateDiff(range);
+        return true;
+    }
+
+
+    bool PoolDiffTracker::erase_new(const Range& range)
+    {
+        if (new_pool_.erase(range) == 0)
+        {
+            return false;
+        }
+        changeCoverage(new_coverage_, range, false);
+        updateDiff(range);
+        return true;
+    }
+
+
+    void PoolDiffTracker::updateDiff(const Range& range)
+    {
+        const auto [first, last] = range;
+
+        // Diff ranges which intersect or touch the changed range are taken out,
+        // their parts outside of it are still valid and are glued back later
+        //
+        //     diff              [-----]   [---]    [--------]
+        //     changed range         [................]
+        //     kept parts        [---]                  [----]
+        auto touched = diff_.lower_bound(Range{first, 0});
+        if (touched != diff_.begin() && (std::prev(touched)->second >= first || first - std::prev(touched)->second == 1))
+        {
+            --touched;
+        }
+        std::optional<Range> left_part, right_part;
+        while (touched != diff_.end() && (touched->first <= last || touched->first - last == 1))
+        {
+            if (touched->first < first)
+            {
+                left_part = Range{touched->first, first - 1};
+            }
+            if (touched->second > last)
+            {
+                right_part = Range{last + 1, touched->second};
+            }
+            touched = diff_.erase(touched);
+        }
+
+        DiffBuilder builder(diff_);
+        if (left_part)
+        {
+            builder.add(left_part->first, left_part->second);
+        }
+
+        // Walk over segments of both pools which intersect the changed range
+        auto old_segment = findSegment(old_coverage_, first);
+        auto new_segment = findSegment(new_coverage_, first);
+        for (IPAddress segment_first = first; ; )
+        {
+            const auto old_next = std::next(old_segment);
+            const auto new_next = std::next(new_segment);
+            IPAddress segment_last = last;
+            if (old_next != old_coverage_.cend())
+            {
+                segment_last = std::min(segment_last, old_next->first - 1);
+            }
+            if (new_next != new_coverage_.cend())
+            {
+                segment_last = std::min(segment_last, new_next->first - 1);
+            }
+
+            if (old_segment->second > 0 && new_segment->second == 0)
+            {
+                builder.add(segment_first, segment_last);
+            }
+            if (segment_last == last)
+            {
+                break;
+            }
+
+            segment_first = segment_last + 1;
+            if (old_next != old_coverage_.cend() && old_next->first == segment_first)
+            {
+                old_segment = old_next;
+            }
+            if (new_next != new_coverage_.cend() && new_next->first == segment_first)
+            {
+                new_segment = new_next;
+            }
+        }
+
+        if (right_part)
+        {
+            builder.add(right_part->first, right_part->second);
+        }
+        builder.flush();
+    }
+
+} // namespace netup_tt
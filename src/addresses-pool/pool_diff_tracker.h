@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+
+#include <map>
+
+#include "ipv4_pools.h"
+
+
+namespace netup_tt
+{
+
+    // Keeps two pools together with their diff (`find_diff(old_pool, new_pool)`) and updates the diff
+    // as ranges are inserted into pools or erased from them, instead of finding it from scratch.
+    //
+    // For every pool, the address space is split into segments of the same coverage,
+    // i.e. of the same number of pool's ranges which contain them:
+    //
+    //     ranges      [-------]
+    //                     [-------]      [--]
+    //     coverage   0| 1 | 2 | 1 |  0   |1 |  0
+    //
+    // Insertion or erasure of range [first, last] changes coverage inside it only, so the diff
+    // is found again over [first, last] by walking segments of both pools there and glued
+    // to the unchanged diff around. An update costs O((k + 1) log n), where k is the number
+    // of segments (of both pools) and diff ranges inside the changed range.
+    class PoolDiffTracker
+    {
+    public:
+        PoolDiffTracker();
+        PoolDiffTracker(Pool old_pool, Pool new_pool);
+
+        // Both functions return false (and change nothing) if the range is already in the pool
+        bool insert_old(const Range& range);
+        bool insert_new(const Range& range);
+        // Both functions return false (and change nothing) if the range isn't in the pool
+        bool erase_old(const Range& range);
+        bool erase_new(const Range& range);
+
+        const Pool& old_pool() const noexcept { return old_pool_; }
+        const Pool& new_pool() const noexcept { return new_pool_; }
+        // Always equal to `find_diff(old_pool(), new_pool())`
+        const Pool& diff() const noexcept { return diff_; }
+
+    private:
+        // Start of every segment -> number of ranges which contain it. Segments go up
+        // to the start of the next one, the first one always starts at 0.
+        // Neighbouring segments always have different coverage.
+        using Coverage = std::map<IPAddress, std::size_t>;
+
+        void updateDiff(const Range& range);
+
+        Pool old_pool_;
+        Pool new_pool_;
+        Coverage old_coverage_;
+        Coverage new_coverage_;
+        Pool diff_;
+    };
+
+} // namespace netup_tt
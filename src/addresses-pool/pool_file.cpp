@@ -0,0 +1,144 @@
+#include "pool_file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+
+namespace netup_tt
+{
+
+    namespace
+    {
+
+        [[noreturn]] void throwWriteError(const std::filesystem::path& path)
+        {
+            throw std::system_error(errno, std::generic_category(), "Can't write pool file: " + path.string());
+        }
+
+
+        template <typename Iterator>
+        bool areReduced(const Iterator begin, const Iterator end)
+        {
+            return std::adjacent_find(begin, end, [](const Range& lhs, const Range& rhs)
+            {
+                return !(lhs.second < rhs.first && rhs.first - lhs.second > 1);
+            }) == end;
+        }
+
+
+        template <typename Iterator>
+        void writeRanges(
+            const std::filesystem::path& path,
+            const Iterator begin,
+            const Iterator end,
+            const std::size_t ranges_count,
+            const bool normalized
+        )
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file)
+            {
+                throwWriteError(path);
+            }
+
+            PoolFileHeader header;
+            header.flags = normalized ? PoolFileHeader::normalized_flag : 0;
+            header.ranges_count = ranges_count;
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+            // `Pool` isn't contiguous, so ranges are written through a buffer
+            constexpr std::size_t buffer_size = 8192;
+            std::vector<Range> buffer;
+            buffer.reserve(buffer_size);
+            for (auto iter = begin; iter != end && file; )
+            {
+                buffer.clear();
+                for (; iter != end && buffer.size() < buffer_size; ++iter)
+                {
+                    buffer.push_back(*iter);
+                }
+                file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(Range)));
+            }
+
+            file.close();
+            if (!file)
+            {
+                throwWriteError(path);
+            }
+        }
+
+
+        [[noreturn]] void throwFormatError(const std::filesystem::path& path, const std::string& what)
+        {
+            throw PoolFileError("Invalid pool file " + path.string() + ": " + what);
+        }
+
+    } // anonymous namespace
+
+
+    void write_pool_file(const std::filesystem::path& path, const Pool& pool)
+    {
+        writeRanges(path, pool.cbegin(), pool.cend(), pool.size(), areReduced(pool.cbegin(), pool.cend()));
+    }
+
+
+    void write_pool_file(const std::filesystem::path& path, const FlatPool& pool)
+    {
+        writeRanges(path, pool.begin(), pool.end(), pool.size(), pool.is_reduced());
+    }
+
+
+    void write_pool_file(const std::filesystem::path& path, const NormalizedPool& pool)
+    {
+        writeRanges(path, pool.begin(), pool.end(), pool.size(), true);
+    }
+
+
+    MappedPoolFile::MappedPoolFile(const std::filesystem::path& path)
+        : file_(path, MappedFile::Access::sequential)
+    {
+        const auto bytes = file_.bytes();
+        PoolFileHeader header;
+        if (bytes.size() < sizeof(header))
+        {
+            throwFormatError(path, "file is too small for the header");
+        }
+        std::copy_n(bytes.data(), sizeof(header), reinterpret_cast<std::byte*>(&header));
+
+        if (header.magic != PoolFileHeader::expected_magic)
+        {
+            throwFormatError(path, "wrong magic");
+        }
+        if (header.version != PoolFileHeader::current_version)
+        {
+            throwFormatError(path, "unsupported version " + std::to_string(header.version));
+        }
+        if ((header.flags & ~PoolFileHeader::normalized_flag) != 0)
+        {
+            throwFormatError(path, "unknown flags");
+        }
+        if (header.ranges_count != (bytes.size() - sizeof(header)) / sizeof(Range)
+            || (bytes.size() - sizeof(header)) % sizeof(Range) != 0)
+        {
+            throwFormatError(path, "size of the file doesn't match the number of ranges");
+        }
+
+        // Mapping is page-aligned and the header takes 16 bytes, so ranges are aligned properly
+        ranges_ = std::span<const Range>(
+            reinterpret_cast<const Range*>(bytes.data() + sizeof(header)),
+            static_cast<std::size_t>(header.ranges_count)
+        );
+        normalized_ = (header.flags & PoolFileHeader::normalized_flag) != 0;
+    }
+
+
+    Pool MappedPoolFile::to_pool() const
+    {
+        return Pool(ranges_.begin(), ranges_.end());
+    }
+
+} // namespace netup_tt
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <filesystem>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#include "flat_pool.h"
+#include "ipv4_pools.h"
+#include "mapped_file.h"
+#include "normalized_pool.h"
+
+
+namespace netup_tt
+{
+
+    // Binary pool file:
+    //
+    //     offset  size
+    //     0       4       magic "NTPL"
+    //     4       2       format version (1)
+    //     6       2       flags: bit 0 is set if ranges are normalized (reduced, like `NormalizedPool`)
+    //     8       8       number of ranges
+    //     16      8 * n   ranges as pairs of `uint32` (first, last), sorted like in `Pool`
+    //
+    // All numbers are little-endian. Ranges go right after the 16-byte header, so a mapped file
+    // may be read as an array of `Range` with no copying or parsing.
+    struct PoolFileHeader
+    {
+        static constexpr std::array<char, 4> expected_magic{'N', 'T', 'P', 'L'};
+        static constexpr std::uint16_t current_version = 1;
+        static constexpr std::uint16_t normalized_flag = 1;
+
+        std::array<char, 4> magic{expected_magic};
+        std::uint16_t version{current_version};
+        std::uint16_t flags{0};
+        std::uint64_t ranges_count{0};
+    };
+
+    static_assert(sizeof(PoolFileHeader) == 16 && std::is_trivially_copyable_v<PoolFileHeader>);
+    // Zero-copy reading relies on the memory layout of ranges matching the file
+    static_assert(std::endian::native == std::endian::little, "Pool files are little-endian");
+    static_assert(sizeof(Range) == 2 * sizeof(IPAddress) && std::is_standard_layout_v<Range>);
+
+
+    // Thrown when a file isn't a valid pool file
+    class PoolFileError : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+
+    // Writes pool to a binary pool file, the normalized flag is set if its ranges are reduced.
+    // Failures are thrown as `std::system_error`.
+    void write_pool_file(const std::filesystem::path& path, const Pool& pool);
+    void write_pool_file(const std::filesystem::path& path, const FlatPool& pool);
+    void write_pool_file(const std::filesystem::path& path, const NormalizedPool& pool);
+
+
+    // Pool which is read from a memory mapped binary pool file. Pages are loaded
+    // by the OS on demand, so pools much bigger than the heap (or RAM) may be diffed.
+    // Header and size of the file are checked on opening, `PoolFileError` is thrown if they are wrong.
+    // Order of ranges isn't checked (that would read the whole file), files are expected to be written
+    // by `write_pool_file`.
+    class MappedPoolFile
+    {
+    public:
+        using const_iterator = std::span<const Range>::iterator;
+
+        MappedPoolFile() = default;
+        explicit MappedPoolFile(const std::filesystem::path& path);
+
+        Pool to_pool() const;
+
+        std::span<const Range> ranges() const noexcept { return ranges_; }
+        bool is_normalized() const noexcept { return normalized_; }
+        std::size_t size() const noexcept { return ranges_.size(); }
+        bool empty() const noexcept { return ranges_.empty(); }
+        const_iterator begin() const noexcept { return ranges_.begin(); }
+        const_iterator end() const noexcept { return ranges_.end(); }
+
+    private:
+        MappedFile file_;
+        std::span<const Range> ranges_;
+        bool normalized_{true};
+    };
+
+
+    namespace detail
+    {
+
+        // Ranges of normalized files are taken as they are, others are reduced on the fly
+        template <typename Visitor>
+        decltype(auto) visitRangesReader(const MappedPoolFile& pool, Visitor&& visitor)
+        {
+            if (pool.is_normalized())
+            {
+                return std::invoke(visitor, PlainRangesReader(pool.begin(), pool.end()));
+            }
+            return std::invoke(visitor, ReducedRangesReader(pool.begin(), pool.end()));
+        }
+
+    } // namespace detail
+
+
+    // Diff of two pool files, same as the one for `FlatPool`
+    // (including galloping over a much bigger normalized pool)
+
+    template <typename Sink>
+        requires std::invocable<Sink&, const Range&>
+    void find_diff(const MappedPoolFile& old_pool, const MappedPoolFile& new_pool, Sink&& sink)
+    {
+        const auto emit = [&sink](const IPAddress first, const IPAddress last) { std::invoke(sink, Range{first, last}); };
+
+        if (new_pool.is_normalized() && detail::isWorthGalloping(new_pool.size(), old_pool.size()))
+        {
+            detail::visitRangesReader(old_pool, [&](auto next_old)
+            {
+                detail::findDiffGallopingNew(next_old, new_pool.begin(), new_pool.end(), emit);
+            });
+        }
+        else if (old_pool.is_normalized() && detail::isWorthGalloping(old_pool.size(), new_pool.size()))
+        {
+            detail::visitRangesReader(new_pool, [&](auto next_new)
+            {
+                detail::findDiffGallopingOld(old_pool.begin(), old_pool.end(), next_new, emit);
+            });
+        }
+        else
+        {
+            detail::visitRangesReader(old_pool, [&](auto next_old)
+            {
+                detail::visitRangesReader(new_pool, [&](auto next_new)
+                {
+                    detail::findDiff(next_old, next_new, emit);
+                });
+            });
+        }
+    }
+
+    template <typename OutputIterator>
+        requires std::output_iterator<OutputIterator, Range>
+    OutputIterator find_diff(const MappedPoolFile& old_pool, const MappedPoolFile& new_pool, OutputIterator out)
+    {
+        find_diff(old_pool, new_pool, [&out](const Range& range) { *out++ = range; });
+        return out;
+    }
+
+} // namespace netup_tt
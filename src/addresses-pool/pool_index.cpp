@@ -0,0 +1,170 @@
+#include "pool_index.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <xmmintrin.h>
+#endif
+
+
+namespace netup_tt
+{
+
+    namespace
+    {
+
+        void prefetch(const void* const address) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(address);
+#elif defined(_MSC_VER)
+            _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+            static_cast<void>(address);
+#endif
+        }
+
+
+        // Bits of `k` are the path from the root: 0 is a turn to the left, 1 is to the right.
+        // Drops the trailing turns to the right and the last turn to the left before them,
+        // i.e. goes up to the closest ancestor which has `k` in its left subtree (0 if there is none).
+        // When a search goes below the leaves, that ancestor is the node searched for.
+        std::size_t dropRightTurns(const std::size_t k) noexcept
+        {
+            return k >> (std::countr_one(k) + 1);
+        }
+
+
+        // Searches of a batch go through the tree simultaneously, level by level
+        constexpr std::size_t batch_size = 16;
+
+    } // anonymous namespace
+
+
+    PoolIndex::PoolIndex()
+        : nodes_{Node{0, 1}}
+    {
+    }
+
+
+    PoolIndex::PoolIndex(const Pool& pool)
+        : PoolIndex(NormalizedPool(pool).ranges())
+    {
+    }
+
+
+    PoolIndex::PoolIndex(const FlatPool& pool)
+        : PoolIndex(NormalizedPool(pool).ranges())
+    {
+    }
+
+
+    PoolIndex::PoolIndex(const NormalizedPool& pool)
+        : PoolIndex(pool.ranges())
+    {
+    }
+
+
+    PoolIndex::PoolIndex(const std::vector<Range>& reduced_ranges)
+        : nodes_(reduced_ranges.size() + 1, Node{0, 1})
+        , full_levels_(static_cast<std::size_t>(std::bit_width(reduced_ranges.size() + 1) - 1))
+    {
+        // In-order walk over the tree puts sorted ranges into their places
+        const std::size_t count = reduced_ranges.size();
+        const auto go_leftmost = [count](std::size_t k)
+        {
+            while (2 * k <= count)
+            {
+                k *= 2;
+            }
+            return k;
+        };
+
+        std::size_t k = go_leftmost(1);
+        for (const auto& range : reduced_ranges)
+        {
+            nodes_[k] = Node{range.second, range.first};
+            // The next node in order is the leftmost one of the right subtree or, if there is
+            // no right subtree, the closest ancestor which has the current node in its left subtree
+            k = 2 * k + 1 <= count ? go_leftmost(2 * k + 1) : dropRightTurns(k);
+        }
+    }
+
+
+    std::size_t PoolIndex::findNode(const IPAddress address) const noexcept
+    {
+        const Node* const nodes = nodes_.data();
+        const std::size_t count = size();
+        std::size_t k = 1;
+        for (std::size_t level = 0; level < full_levels_; ++level)
+        {
+            // Descendants of `k` three levels below share one cache line
+            prefetch(nodes + std::min(8 * k, count));
+            k = 2 * k + (nodes[k].last < address);
+        }
+        return finishSearch(k, address);
+    }
+
+
+    std::size_t PoolIndex::finishSearch(const std::size_t k, const IPAddress address) const noexcept
+    {
+        // The last level may be filled partially. Missing nodes behave as if `address` is after them
+        const bool exists = k <= size();
+        return dropRightTurns(2 * k + ((nodes_[exists ? k : 0].last < address) | !exists));
+    }
+
+
+    bool PoolIndex::contains(const IPAddress address) const noexcept
+    {
+        const Node& node = nodes_[findNode(address)];
+        return node.first <= address && address <= node.last;
+    }
+
+
+    void PoolIndex::contains(const std::span<const IPAddress> addresses, const std::span<std::uint64_t> bitmask) const
+    {
+        constexpr std::size_t word_bits = 64;
+        const std::size_t words_count = (addresses.size() + word_bits - 1) / word_bits;
+        if (bitmask.size() < words_count)
+        {
+            throw std::invalid_argument("PoolIndex::contains: bitmask is too small for addresses");
+        }
+        std::fill_n(bitmask.begin(), words_count, 0);
+
+        const Node* const nodes = nodes_.data();
+        const std::size_t count = size();
+        for (std::size_t batch_begin = 0; batch_begin < addresses.size(); batch_begin += batch_size)
+        {
+            const std::size_t batch_end = std::min(batch_begin + batch_size, addresses.size());
+            const std::size_t searches = batch_end - batch_begin;
+            const IPAddress* const batch = addresses.data() + batch_begin;
+
+            // Node which is read by a search on the next level is prefetched right after
+            // the current one is passed. Other searches of the batch go meanwhile.
+            std::array<std::size_t, batch_size> k;
+            k.fill(1);
+            for (std::size_t level = 0; level < full_levels_; ++level)
+            {
+                for (std::size_t search = 0; search < searches; ++search)
+                {
+                    k[search] = 2 * k[search] + (nodes[k[search]].last < batch[search]);
+                    prefetch(nodes + std::min(k[search], count));
+                }
+            }
+
+            for (std::size_t search = 0; search < searches; ++search)
+            {
+                const IPAddress address = batch[search];
+                const Node& node = nodes[finishSearch(k[search], address)];
+                const bool is_contained = node.first <= address && address <= node.last;
+
+                const std::size_t index = batch_begin + search;
+                bitmask[index / word_bits] |= static_cast<std::uint64_t>(is_contained) << (index % word_bits);
+            }
+        }
+    }
+
+} // namespace netup_tt
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <new>
+#include <span>
+#include <vector>
+
+#include "flat_pool.h"
+#include "ipv4_pools.h"
+#include "normalized_pool.h"
+
+
+namespace netup_tt
+{
+
+    namespace detail
+    {
+
+        // Allocates memory aligned by cache line, so every group of 8 nodes of `PoolIndex`
+        // which are children of the same node 3 levels above (see below) takes exactly one cache line
+        template <typename T>
+        struct CacheLineAllocator
+        {
+            using value_type = T;
+            static constexpr std::size_t alignment = 64;
+
+            CacheLineAllocator() = default;
+            template <typename U>
+            CacheLineAllocator(const CacheLineAllocator<U>&) noexcept {}
+
+            T* allocate(const std::size_t count)
+            {
+                return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{alignment}));
+            }
+
+            void deallocate(T* const pointer, std::size_t) noexcept
+            {
+                ::operator delete(pointer, std::align_val_t{alignment});
+            }
+
+            template <typename U>
+            bool operator==(const CacheLineAllocator<U>&) const noexcept { return true; }
+        };
+
+    } // namespace detail
+
+
+    // Read-only index for membership lookups, built from a pool.
+    // Ranges are reduced and laid out in Eytzinger order (as a binary heap: children of node k
+    // are 2k and 2k+1), so the top levels of the search tree share a few cache lines,
+    // and the next levels of a search may be prefetched before they are needed.
+    //
+    //                     [4]
+    //           [2]                 [6]             sorted: [1] [2] [3] [4] [5] [6] [7]
+    //      [1]       [3]       [5]       [7]        stored: [4] [2] [6] [1] [3] [5] [7]
+    //
+    // Search itself has no branches which depend on data, so it doesn't suffer from mispredictions.
+    class PoolIndex
+    {
+    public:
+        PoolIndex();
+        explicit PoolIndex(const Pool& pool);
+        explicit PoolIndex(const FlatPool& pool);
+        explicit PoolIndex(const NormalizedPool& pool);
+
+        bool contains(IPAddress address) const noexcept;
+
+        // Looks up all `addresses` at once, interleaving searches so that memory latency
+        // of one of them is hidden behind the others.
+        // Result is written as a bitmask: bit `i % 64` of `bitmask[i / 64]` is set if `addresses[i]`
+        // is in the pool. `bitmask` should have at least `(addresses.size() + 63) / 64` words,
+        // otherwise `std::invalid_argument` is thrown. Unused bits of the last word are cleared.
+        void contains(std::span<const IPAddress> addresses, std::span<std::uint64_t> bitmask) const;
+
+        // Number of reduced ranges
+        std::size_t size() const noexcept { return nodes_.size() - 1; }
+        bool empty() const noexcept { return size() == 0; }
+
+    private:
+        // `last` goes first since ranges are searched by it
+        struct Node
+        {
+            IPAddress last;
+            IPAddress first;
+        };
+
+        explicit PoolIndex(const std::vector<Range>& reduced_ranges);
+
+        // Returns index of the first node which ends at `address` or after it (0 if there is none)
+        std::size_t findNode(IPAddress address) const noexcept;
+        // Makes the last step of a search which has passed the full levels of the tree and is at node `k`
+        std::size_t finishSearch(std::size_t k, IPAddress address) const noexcept;
+
+        // Node 0 isn't a part of the tree, it's an empty range which is found when nothing else fits
+        std::vector<Node, detail::CacheLineAllocator<Node>> nodes_;
+        // Number of levels of the tree which are completely filled
+        std::size_t full_levels_{0};
+    };
+
+} // namespace netup_tt
@@ -0,0 +1,286 @@
+#include "pool_text.h"
+
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <system_error>
+#include <vector>
+
+#include "cidr.h"
+#include "mapped_file.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define NETUP_TT_HAS_SSSE3_PARSER 1
+#include <immintrin.h>
+#endif
+
+
+namespace netup_tt
+{
+
+    namespace
+    {
+
+        // The longest address is "255.255.255.255"
+        constexpr int max_address_length = 15;
+
+
+        [[noreturn]] void throwError(const std::string_view text, const char* const position, const std::string& what)
+        {
+            // Lines are counted only when something is wrong, so parsing doesn't pay for it
+            const auto line = static_cast<std::size_t>(std::count(text.data(), position, '\n')) + 1;
+            throw PoolTextError(line, what);
+        }
+
+
+        bool isDigit(const char c)
+        {
+            return c >= '0' && c <= '9';
+        }
+
+
+        // Parses a number of at most `max_digits` digits
+        const char* parseNumber(const char* const current, const char* const end, const int max_digits, std::uint32_t& number)
+        {
+            const auto [next, error] = std::from_chars(current, current + std::min<std::ptrdiff_t>(max_digits, end - current), number);
+            return error == std::errc{} ? next : nullptr;
+        }
+
+
+        // Returns position after the address, or null if there is no valid address at `current`
+        const char* parseAddressScalar(const char* current, const char* const end, IPAddress& address)
+        {
+            address = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                if (i > 0)
+                {
+                    if (current == end || *current != '.')
+                    {
+                        return nullptr;
+                    }
+                    ++current;
+                }
+                std::uint32_t number = 0;
+                current = parseNumber(current, end, 3, number);
+                if (current == nullptr || number > 255)
+                {
+                    return nullptr;
+                }
+                address = (address << 8) | number;
+            }
+            // Same as for the SSSE3 parser, "1.2.3.4567" and "1.2.3.4." aren't addresses followed by something
+            if (current != end && (isDigit(*current) || *current == '.'))
+            {
+                return nullptr;
+            }
+            return current;
+        }
+
+
+#ifdef NETUP_TT_HAS_SSSE3_PARSER
+        // Shuffle patterns for every combination of lengths of the four numbers (1 to 3 digits each).
+        // Every number goes into its own 32-bit lane as bytes [0, hundreds, tens, ones],
+        // indexes with the high bit set give zeros for missing digits.
+        using ShufflePattern = std::array<std::uint8_t, 16>;
+
+        constexpr std::array<ShufflePattern, 81> makeShufflePatterns()
+        {
+            std::array<ShufflePattern, 81> patterns{};
+            for (std::size_t index = 0; index < patterns.size(); ++index)
+            {
+                const std::size_t lengths[4]{index / 27 % 3 + 1, index / 9 % 3 + 1, index / 3 % 3 + 1, index % 3 + 1};
+                std::size_t number_end = 0;
+                for (std::size_t i = 0; i < 4; ++i)
+                {
+                    number_end += lengths[i];
+                    for (std::size_t digit = 0; digit < 4; ++digit)
+                    {
+                        // Digit 3 is ones, 2 is tens, 1 is hundreds
+                        const std::size_t from_end = 4 - digit;
+                        patterns[index][4 * i + digit] = digit > 0 && from_end <= lengths[i]
+                            ? static_cast<std::uint8_t>(number_end - from_end)
+                            : 0x80;
+                    }
+                    ++number_end;
+                }
+            }
+            return patterns;
+        }
+
+        alignas(16) constexpr std::array<ShufflePattern, 81> shuffle_patterns = makeShufflePatterns();
+
+
+        // Same as `parseAddressScalar`, but 16 bytes starting from `current` should be readable.
+        //
+        //     text       "10.200.3.45-..."
+        //     dots       __x___x_x_______        the address ends at '-' (neither a digit nor a dot)
+        //     lengths    2   3   1 2             pattern index (2-1)*27 + (3-1)*9 + (1-1)*3 + (2-1)
+        //     lanes      [0 0 1 0] [0 2 0 0] [0 0 0 3] [0 0 4 5]
+        //     numbers    10        200       3         45
+        __attribute__((target("ssse3")))
+        const char* parseAddressSsse3(const char* const current, IPAddress& address)
+        {
+            const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current));
+            // Bytes which aren't digits become bigger than 9 (as unsigned numbers)
+            const __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+            const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+            const __m128i is_dot = _mm_cmpeq_epi8(chars, _mm_set1_epi8('.'));
+            const auto digits_mask = static_cast<std::uint32_t>(_mm_movemask_epi8(is_digit));
+            const auto dots_mask = static_cast<std::uint32_t>(_mm_movemask_epi8(is_dot));
+
+            const int length = std::countr_one(digits_mask | dots_mask);
+            const std::uint32_t dots = dots_mask & ((std::uint32_t{1} << length) - 1);
+            const std::uint32_t dots_after_first = dots & (dots - 1);
+            const std::uint32_t dots_after_second = dots_after_first & (dots_after_first - 1);
+            const int first_dot = std::countr_zero(dots);
+            const int second_dot = std::countr_zero(dots_after_first);
+            const int third_dot = std::countr_zero(dots_after_second);
+            // Lengths minus one, which should be 0 to 2 (a missing dot makes the next one huge)
+            const auto length_0 = static_cast<std::uint32_t>(first_dot - 1);
+            const auto length_1 = static_cast<std::uint32_t>(second_dot - first_dot - 2);
+            const auto length_2 = static_cast<std::uint32_t>(third_dot - second_dot - 2);
+            const auto length_3 = static_cast<std::uint32_t>(length - third_dot - 2);
+            if ((length > max_address_length) | ((dots_after_second & (dots_after_second - 1)) != 0)
+                | (length_0 > 2) | (length_1 > 2) | (length_2 > 2) | (length_3 > 2))
+            {
+                return nullptr;
+            }
+
+            const auto& pattern = shuffle_patterns[length_0 * 27 + length_1 * 9 + length_2 * 3 + length_3];
+            const __m128i lane_digits = _mm_shuffle_epi8(digits, _mm_load_si128(reinterpret_cast<const __m128i*>(pattern.data())));
+
+            // 16-bit [0 * 0 + hundreds * 100, tens * 10 + ones * 1], then their 32-bit sums
+            const __m128i weights = _mm_setr_epi8(0, 100, 10, 1, 0, 100, 10, 1, 0, 100, 10, 1, 0, 100, 10, 1);
+            const __m128i numbers = _mm_madd_epi16(_mm_maddubs_epi16(lane_digits, weights), _mm_set1_epi16(1));
+            if (_mm_movemask_epi8(_mm_cmpgt_epi32(numbers, _mm_set1_epi32(255))) != 0)
+            {
+                return nullptr;
+            }
+
+            // The first number is the highest byte of the address
+            const __m128i bytes = _mm_shuffle_epi8(numbers, _mm_setr_epi8(12, 8, 4, 0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+            address = static_cast<IPAddress>(_mm_cvtsi128_si32(bytes));
+            return current + length;
+        }
+#endif
+
+
+        template <typename ParseAddress>
+        std::vector<Range> parseRanges(const std::string_view text, ParseAddress parse_address)
+        {
+            std::vector<Range> ranges;
+            const char* current = text.data();
+            const char* const end = current + text.size();
+            while (current != end)
+            {
+                if (*current == '\n')
+                {
+                    ++current;
+                    continue;
+                }
+                if (*current == '\r' && end - current >= 2 && current[1] == '\n')
+                {
+                    current += 2;
+                    continue;
+                }
+
+                const char* const line = current;
+                IPAddress first = 0;
+                if ((current = parse_address(current, end, first)) == nullptr)
+                {
+                    throwError(text, line, "wrong address");
+                }
+                IPAddress last = first;
+                if (current != end && *current == '-')
+                {
+                    if ((current = parse_address(current + 1, end, last)) == nullptr)
+                    {
+                        throwError(text, line, "wrong address at the end of range");
+                    }
+                    if (last < first)
+                    {
+                        throwError(text, line, "range ends before it starts");
+                    }
+                }
+                else if (current != end && *current == '/')
+                {
+                    std::uint32_t prefix_length = 0;
+                    if ((current = parseNumber(current + 1, end, 2, prefix_length)) == nullptr)
+                    {
+                        throwError(text, line, "wrong prefix length");
+                    }
+                    const Cidr cidr{first, static_cast<std::uint8_t>(prefix_length)};
+                    if (!cidr.is_valid())
+                    {
+                        throwError(text, line, "invalid prefix");
+                    }
+                    last = cidr.to_range().second;
+                }
+
+                if (current != end && *current == '\r')
+                {
+                    ++current;
+                }
+                if (current != end)
+                {
+                    if (*current != '\n')
+                    {
+                        throwError(text, line, "unexpected characters after range");
+                    }
+                    ++current;
+                }
+                ranges.emplace_back(first, last);
+            }
+            return ranges;
+        }
+
+    } // anonymous namespace
+
+
+    PoolTextError::PoolTextError(const std::size_t line, const std::string& what)
+        : std::runtime_error("Invalid pool text, line " + std::to_string(line) + ": " + what)
+        , line_(line)
+    {
+    }
+
+
+    FlatPool parse_pool_text(const std::string_view text, const AddressParser parser)
+    {
+#ifdef NETUP_TT_HAS_SSSE3_PARSER
+        if (parser != AddressParser::scalar && is_ssse3_parser_supported())
+        {
+            return FlatPool(parseRanges(text, [](const char* const current, const char* const end, IPAddress& address)
+            {
+                return end - current >= 16 ? parseAddressSsse3(current, address) : parseAddressScalar(current, end, address);
+            }));
+        }
+#else
+        static_cast<void>(parser);
+#endif
+        return FlatPool(parseRanges(text, parseAddressScalar));
+    }
+
+
+    FlatPool load_pool_text(const std::filesystem::path& path, const AddressParser parser)
+    {
+        const MappedFile file(path, MappedFile::Access::sequential);
+        const auto bytes = file.bytes();
+        return parse_pool_text(std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size()), parser);
+    }
+
+
+    bool is_ssse3_parser_supported() noexcept
+    {
+#ifdef NETUP_TT_HAS_SSSE3_PARSER
+        static const bool supported = __builtin_cpu_supports("ssse3");
+        return supported;
+#else
+        return false;
+#endif
+    }
+
+} // namespace netup_tt
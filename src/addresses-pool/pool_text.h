@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "flat_pool.h"
+
+
+namespace netup_tt
+{
+
+    // Text pools have one range per line, in one of three forms:
+    //
+    //     10.0.0.1-10.0.0.200      range (both ends are included)
+    //     192.168.0.0/16           prefix, bits after the prefix should be zeros
+    //     172.16.5.4               single address
+    //
+    // Lines may end with "\n" or "\r\n", empty lines are skipped. Every number of an address
+    // has 1 to 3 digits. Ranges may go in any order and intersect, they are collected
+    // into a sorted array right away, without inserting them into a tree one by one.
+    //
+    // Addresses are parsed 16 bytes at once with SSSE3 if the CPU supports it: dots are found
+    // by one comparison, digits of every number are shuffled into their own 32-bit lane,
+    // and all four numbers are computed by two multiply-add instructions.
+    // Lines near the end of the text (where 16 bytes can't be read) are parsed by scalar code.
+
+
+    // Thrown when text isn't a valid pool, with the number of the wrong line (counted from 1)
+    class PoolTextError : public std::runtime_error
+    {
+    public:
+        PoolTextError(std::size_t line, const std::string& what);
+
+        std::size_t line() const noexcept { return line_; }
+
+    private:
+        std::size_t line_;
+    };
+
+
+    enum class AddressParser
+    {
+        // The best one supported by the CPU
+        automatic,
+        scalar,
+        // Falls back to `scalar` if the CPU doesn't support it
+        ssse3
+    };
+
+
+    FlatPool parse_pool_text(std::string_view text, AddressParser parser = AddressParser::automatic);
+
+    // The file is memory mapped and read sequentially, failures to read it are thrown as `std::system_error`
+    FlatPool load_pool_text(const std::filesystem::path& path, AddressParser parser = AddressParser::automatic);
+
+    bool is_ssse3_parser_supported() noexcept;
+
+} // namespace netup_tt
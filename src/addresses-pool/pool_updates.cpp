@@ -0,0 +1,130 @@
+#include "pool_updates.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+
+namespace netup_tt
+{
+
+    namespace
+    {
+
+        // Reduced ranges of `pool`, so that the update doesn't depend on its form
+        template <typename Function>
+        void forEachReducedRange(const Pool& pool, Function&& function)
+        {
+            detail::ReducedRangesReader next_range(pool.cbegin(), pool.cend());
+            while (const auto range = next_range())
+            {
+                function(*range);
+            }
+        }
+
+
+        // Replaces the range at `iter` reusing its node, returns iterator to the next range
+        Pool::iterator replaceRange(Pool& pool, const Pool::iterator iter, const Range& range)
+        {
+            const auto next = std::next(iter);
+            auto node = pool.extract(iter);
+            node.value() = range;
+            // Order of ranges doesn't change, so the hint is exact
+            pool.insert(next, std::move(node));
+            return next;
+        }
+
+
+        void subtractRange(Pool& pool, const Range& range)
+        {
+            // The first range which may intersect `range`: ranges are reduced, so their ends
+            // are sorted too, and only the previous one of the ranges starting at `range.first`
+            // or after it may reach it
+            auto iter = pool.lower_bound(Range{range.first, 0});
+            if (iter != pool.begin() && std::prev(iter)->second >= range.first)
+            {
+                --iter;
+            }
+
+            while (iter != pool.end() && iter->first <= range.second)
+            {
+                const Range current = *iter;
+                const bool keep_left = current.first < range.first;
+                const bool keep_right = current.second > range.second;
+                if (keep_left && keep_right)
+                {
+                    // `range` is inside of `current`
+                    const auto next = replaceRange(pool, iter, Range{current.first, range.first - 1});
+                    pool.emplace_hint(next, range.second + 1, current.second);
+                    return;
+                }
+                if (keep_left)
+                {
+                    iter = replaceRange(pool, iter, Range{current.first, range.first - 1});
+                }
+                else if (keep_right)
+                {
+                    replaceRange(pool, iter, Range{range.second + 1, current.second});
+                    return;
+                }
+                else
+                {
+                    iter = pool.erase(iter);
+                }
+            }
+        }
+
+
+        void addRange(Pool& pool, const Range& range)
+        {
+            // Ranges which intersect `range` or touch it are [touched_begin, touched_end)
+            auto touched_begin = pool.lower_bound(Range{range.first, 0});
+            if (touched_begin != pool.begin() && !detail::isSeparated(*std::prev(touched_begin), range.first))
+            {
+                --touched_begin;
+            }
+            auto touched_end = touched_begin;
+            Range merged = range;
+            for (; touched_end != pool.end() && !detail::isSeparated(merged, touched_end->first); ++touched_end)
+            {
+                merged.first = std::min(merged.first, touched_end->first);
+                merged.second = std::max(merged.second, touched_end->second);
+            }
+
+            if (touched_begin == touched_end)
+            {
+                pool.emplace_hint(touched_end, range);
+                return;
+            }
+            // The first touched node is reused for the merged range, the others are erased
+            pool.erase(std::next(touched_begin), touched_end);
+            replaceRange(pool, touched_begin, merged);
+        }
+
+    } // anonymous namespace
+
+
+    void subtract_in_place(Pool& pool, const Pool& subtrahend)
+    {
+        forEachReducedRange(subtrahend, [&pool](const Range& range) { subtractRange(pool, range); });
+    }
+
+
+    void add_in_place(Pool& pool, const Pool& addend)
+    {
+        forEachReducedRange(addend, [&pool](const Range& range) { addRange(pool, range); });
+    }
+
+
+    void subtract_in_place(NormalizedPool& pool, const Pool& subtrahend)
+    {
+        forEachReducedRange(subtrahend, [&pool](const Range& range) { pool.erase(range); });
+    }
+
+
+    void add_in_place(NormalizedPool& pool, const Pool& addend)
+    {
+        forEachReducedRange(addend, [&pool](const Range& range) { pool.insert(range); });
+    }
+
+} // namespace netup_tt
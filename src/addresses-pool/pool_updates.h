@@ -0,0 +1,30 @@
+#pragma once
+
+#include "ipv4_pools.h"
+#include "normalized_pool.h"
+
+
+namespace netup_tt
+{
+
+    // In-place versions of set operations, for live pools which are changed by small updates
+    // (like removing a diff which has been handled). Only ranges of `pool` which intersect
+    // or touch ranges of the update are changed, so an update of k ranges costs O(k log n)
+    // for a pool of n ranges, nothing is copied.
+    //
+    // `pool` should be reduced (like results of `find_diff`), and it stays reduced.
+    // Ranges of the update may be in any form. Nodes of changed ranges are extracted from the tree,
+    // changed and put back to the same place, so nothing is allocated except one node when
+    // a range is split in two.
+
+    // Removes addresses of `subtrahend` from `pool`
+    void subtract_in_place(Pool& pool, const Pool& subtrahend);
+    // Adds addresses of `addend` to `pool`, merging ranges which intersect or touch
+    void add_in_place(Pool& pool, const Pool& addend);
+
+    // Same for `NormalizedPool` (see `NormalizedPool::insert` and `NormalizedPool::erase`),
+    // every range of the update costs O(log n) plus a shift of the following ranges
+    void subtract_in_place(NormalizedPool& pool, const Pool& subtrahend);
+    void add_in_place(NormalizedPool& pool, const Pool& addend);
+
+} // namespace netup_tt
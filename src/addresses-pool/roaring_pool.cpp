@@ -0,0 +1,464 @@
+#include "roaring_pool.h"
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <limits>
+
+
+namespace netup_tt
+{
+
+    namespace
+    {
+
+        using ChunkForm = RoaringPool::ChunkForm;
+        using ChunkRuns = RoaringPool::ChunkRuns;
+        using ChunkArray = RoaringPool::ChunkArray;
+        using ChunkBitmap = RoaringPool::ChunkBitmap;
+        using Chunk = RoaringPool::Chunk;
+
+        constexpr std::size_t chunk_words = RoaringPool::chunk_words;
+        constexpr std::size_t word_bits = 64;
+        constexpr std::uint32_t max_low_half = std::numeric_limits<std::uint16_t>::max();
+
+
+        // Sizes which decide the form of a chunk
+        struct ChunkStatistics
+        {
+            std::size_t runs_count = 0;
+            std::size_t addresses_count = 0;
+        };
+
+
+        ChunkForm chooseForm(const ChunkStatistics& statistics)
+        {
+            const std::size_t runs_bytes = statistics.runs_count * sizeof(ChunkRuns::value_type);
+            const std::size_t array_bytes = statistics.addresses_count * sizeof(ChunkArray::value_type);
+            const std::size_t bitmap_bytes = chunk_words * sizeof(ChunkBitmap::value_type);
+            if (runs_bytes <= array_bytes && runs_bytes <= bitmap_bytes)
+            {
+                return ChunkForm::runs;
+            }
+            return array_bytes <= bitmap_bytes ? ChunkForm::array : ChunkForm::bitmap;
+        }
+
+
+        ChunkForm formOf(const Chunk& chunk)
+        {
+            return static_cast<ChunkForm>(chunk.index());
+        }
+
+
+        ChunkStatistics getStatistics(const Chunk& chunk)
+        {
+            ChunkStatistics statistics;
+            if (const auto* const runs = std::get_if<ChunkRuns>(&chunk))
+            {
+                statistics.runs_count = runs->size();
+                for (const auto& [first, last] : *runs)
+                {
+                    statistics.addresses_count += std::size_t{last} - first + 1;
+                }
+            }
+            else if (const auto* const array = std::get_if<ChunkArray>(&chunk))
+            {
+                statistics.addresses_count = array->size();
+                for (std::size_t index = 0; index < array->size(); ++index)
+                {
+                    statistics.runs_count += index == 0 || (*array)[index] - (*array)[index - 1] != 1 ? 1 : 0;
+                }
+            }
+            else
+            {
+                // A run starts at every set bit whose previous bit isn't set
+                std::uint64_t previous_top_bit = 0;
+                for (const auto word : std::get<ChunkBitmap>(chunk))
+                {
+                    statistics.addresses_count += static_cast<std::size_t>(std::popcount(word));
+                    statistics.runs_count += static_cast<std::size_t>(std::popcount(word & ~(word << 1 | previous_top_bit)));
+                    previous_top_bit = word >> (word_bits - 1);
+                }
+            }
+            return statistics;
+        }
+
+
+        // Calls `callback(first, last)` for every run of a chunk in ascending order
+        template <typename Callback>
+        void forEachRun(const Chunk& chunk, Callback&& callback)
+        {
+            if (const auto* const runs = std::get_if<ChunkRuns>(&chunk))
+            {
+                for (const auto& [first, last] : *runs)
+                {
+                    callback(std::uint32_t{first}, std::uint32_t{last});
+                }
+            }
+            else if (const auto* const array = std::get_if<ChunkArray>(&chunk))
+            {
+                for (auto iter = array->cbegin(); iter != array->cend(); )
+                {
+                    const std::uint32_t first = *iter;
+                    std::uint32_t last = first;
+                    for (++iter; iter != array->cend() && *iter == last + 1; ++iter)
+                    {
+                        ++last;
+                    }
+                    callback(first, last);
+                }
+            }
+            else
+            {
+                // Bits are scanned word by word, jumping over runs of zeros and ones
+                const auto& bitmap = std::get<ChunkBitmap>(chunk);
+                std::uint32_t position = 0;
+                const auto bit_at = [&bitmap](const std::uint32_t index)
+                {
+                    return (bitmap[index / word_bits] >> (index % word_bits)) & 1;
+                };
+                const auto skip = [&bitmap](std::uint32_t index, const bool ones)
+                {
+                    // Returns the first index after `index` where the bit differs from `ones`
+                    while (index <= max_low_half)
+                    {
+                        const std::uint64_t word = ones ? ~bitmap[index / word_bits] : bitmap[index / word_bits];
+                        const std::uint64_t rest = word >> (index % word_bits);
+                        if (rest != 0)
+                        {
+                            return index + static_cast<std::uint32_t>(std::countr_zero(rest));
+                        }
+                        index = (index / word_bits + 1) * word_bits;
+                    }
+                    return max_low_half + 1;
+                };
+                while (position <= max_low_half)
+                {
+                    if (!bit_at(position))
+                    {
+                        position = skip(position, false);
+                        continue;
+                    }
+                    const std::uint32_t end = skip(position, true);
+                    callback(position, end - 1);
+                    position = end;
+                }
+            }
+        }
+
+
+        ChunkRuns toRuns(const Chunk& chunk)
+        {
+            ChunkRuns runs;
+            forEachRun(chunk, [&runs](const std::uint32_t first, const std::uint32_t last)
+            {
+                runs.emplace_back(static_cast<std::uint16_t>(first), static_cast<std::uint16_t>(last));
+            });
+            return runs;
+        }
+
+
+        ChunkArray toArray(const Chunk& chunk)
+        {
+            ChunkArray array;
+            forEachRun(chunk, [&array](const std::uint32_t first, const std::uint32_t last)
+            {
+                for (std::uint32_t address = first; address <= last; ++address)
+                {
+                    array.push_back(static_cast<std::uint16_t>(address));
+                }
+            });
+            return array;
+        }
+
+
+        // Sets or clears bits [first, last]
+        void fillBits(ChunkBitmap& bitmap, const std::uint32_t first, const std::uint32_t last, const bool value)
+        {
+            const std::size_t first_word = first / word_bits;
+            const std::size_t last_word = last / word_bits;
+            const std::uint64_t first_mask = ~std::uint64_t{0} << (first % word_bits);
+            const std::uint64_t last_mask = ~std::uint64_t{0} >> (word_bits - 1 - last % word_bits);
+            for (std::size_t word = first_word; word <= last_word; ++word)
+            {
+                std::uint64_t mask = ~std::uint64_t{0};
+                mask &= word == first_word ? first_mask : mask;
+                mask &= word == last_word ? last_mask : mask;
+                bitmap[word] = value ? bitmap[word] | mask : bitmap[word] & ~mask;
+            }
+        }
+
+
+        ChunkBitmap toBitmap(const Chunk& chunk)
+        {
+            if (const auto* const bitmap = std::get_if<ChunkBitmap>(&chunk))
+            {
+                return *bitmap;
+            }
+            ChunkBitmap bitmap(chunk_words, 0);
+            forEachRun(chunk, [&bitmap](const std::uint32_t first, const std::uint32_t last)
+            {
+                fillBits(bitmap, first, last, true);
+            });
+            return bitmap;
+        }
+
+
+        bool contains(const Chunk& chunk, const std::uint16_t address)
+        {
+            if (const auto* const runs = std::get_if<ChunkRuns>(&chunk))
+            {
+                const auto iter = std::partition_point(runs->cbegin(), runs->cend(), [address](const auto& run)
+                {
+                    return run.second < address;
+                });
+                return iter != runs->cend() && iter->first <= address;
+            }
+            if (const auto* const array = std::get_if<ChunkArray>(&chunk))
+            {
+                return std::binary_search(array->cbegin(), array->cend(), address);
+            }
+            return (std::get<ChunkBitmap>(chunk)[address / word_bits] >> (address % word_bits)) & 1;
+        }
+
+
+        // Kernels of diff for every pair of forms. Results may be of any form (and even empty),
+        // the final form is chosen later.
+        Chunk findChunkDiff(const Chunk& old_chunk, const Chunk& new_chunk)
+        {
+            if (const auto* const old_array = std::get_if<ChunkArray>(&old_chunk))
+            {
+                ChunkArray diff;
+                if (const auto* const new_array = std::get_if<ChunkArray>(&new_chunk))
+                {
+                    std::set_difference(
+                        old_array->cbegin(), old_array->cend(),
+                        new_array->cbegin(), new_array->cend(),
+                        std::back_inserter(diff)
+                    );
+                    return diff;
+                }
+                std::copy_if(old_array->cbegin(), old_array->cend(), std::back_inserter(diff), [&new_chunk](const auto address)
+                {
+                    return !contains(new_chunk, address);
+                });
+                return diff;
+            }
+
+            if (const auto* const old_runs = std::get_if<ChunkRuns>(&old_chunk))
+            {
+                if (const auto* const new_runs = std::get_if<ChunkRuns>(&new_chunk))
+                {
+                    // Runs are reduced ranges, so the general algorithm works for them as it is
+                    ChunkRuns diff;
+                    detail::findDiff(
+                        detail::PlainRangesReader(old_runs->cbegin(), old_runs->cend()),
+                        detail::PlainRangesReader(new_runs->cbegin(), new_runs->cend()),
+                        [&diff](const std::uint32_t first, const std::uint32_t last)
+                        {
+                            diff.emplace_back(static_cast<std::uint16_t>(first), static_cast<std::uint16_t>(last));
+                        }
+                    );
+                    return diff;
+                }
+                if (const auto* const new_array = std::get_if<ChunkArray>(&new_chunk))
+                {
+                    // Runs are cut by the addresses which get into them
+                    ChunkRuns diff;
+                    auto address = new_array->cbegin();
+                    for (const auto& [run_first, run_last] : *old_runs)
+                    {
+                        std::uint32_t first = run_first;
+                        address = std::lower_bound(address, new_array->cend(), run_first);
+                        for (; address != new_array->cend() && *address <= run_last; ++address)
+                        {
+                            if (first < *address)
+                            {
+                                diff.emplace_back(static_cast<std::uint16_t>(first), static_cast<std::uint16_t>(*address - 1));
+                            }
+                            first = std::uint32_t{*address} + 1;
+                        }
+                        if (first <= run_last)
+                        {
+                            diff.emplace_back(static_cast<std::uint16_t>(first), run_last);
+                        }
+                    }
+                    return diff;
+                }
+            }
+
+            // The rest goes through bitmaps
+            ChunkBitmap diff = toBitmap(old_chunk);
+            if (const auto* const new_bitmap = std::get_if<ChunkBitmap>(&new_chunk))
+            {
+                for (std::size_t word = 0; word < chunk_words; ++word)
+                {
+                    diff[word] &= ~(*new_bitmap)[word];
+                }
+            }
+            else
+            {
+                forEachRun(new_chunk, [&diff](const std::uint32_t first, const std::uint32_t last)
+                {
+                    fillBits(diff, first, last, false);
+                });
+            }
+            return diff;
+        }
+
+    } // anonymous namespace
+
+
+    RoaringPool::RoaringPool(const Pool& pool)
+    {
+        // Reduced ranges are cut by chunks' boundaries
+        std::optional<std::uint16_t> key;
+        ChunkRuns runs;
+        detail::ReducedRangesReader next_range(pool.cbegin(), pool.cend());
+        while (const auto range = next_range())
+        {
+            for (std::uint64_t first = range->first; first <= range->second; )
+            {
+                const auto range_key = static_cast<std::uint16_t>(first >> 16);
+                const std::uint64_t last = std::min<std::uint64_t>(range->second, first | max_low_half);
+                if (key != range_key)
+                {
+                    if (key)
+                    {
+                        appendChunk(*key, std::move(runs));
+                    }
+                    key = range_key;
+                    runs = ChunkRuns();
+                }
+                runs.emplace_back(static_cast<std::uint16_t>(first), static_cast<std::uint16_t>(last));
+                first = last + 1;
+            }
+        }
+        if (key)
+        {
+            appendChunk(*key, std::move(runs));
+        }
+    }
+
+
+    void RoaringPool::appendChunk(const std::uint16_t key, Chunk&& chunk)
+    {
+        const auto statistics = getStatistics(chunk);
+        if (statistics.addresses_count == 0)
+        {
+            return;
+        }
+
+        const ChunkForm form = chooseForm(statistics);
+        if (form != formOf(chunk))
+        {
+            switch (form)
+            {
+            case ChunkForm::runs:
+                chunk = toRuns(chunk);
+                break;
+            case ChunkForm::array:
+                chunk = toArray(chunk);
+                break;
+            case ChunkForm::bitmap:
+                chunk = toBitmap(chunk);
+                break;
+            }
+        }
+        keys_.push_back(key);
+        chunks_.push_back(std::move(chunk));
+    }
+
+
+    Pool RoaringPool::to_pool() const
+    {
+        // Runs at the end of a chunk and at the start of the next one are glued
+        Pool pool;
+        std::optional<Range> pending;
+        for (std::size_t index = 0; index < chunks_.size(); ++index)
+        {
+            const IPAddress base = IPAddress{keys_[index]} << 16;
+            forEachRun(chunks_[index], [&](const std::uint32_t first, const std::uint32_t last)
+            {
+                if (pending && pending->second + 1 == base + first)
+                {
+                    pending->second = base + last;
+                    return;
+                }
+                if (pending)
+                {
+                    pool.emplace_hint(pool.cend(), *pending);
+                }
+                pending = Range{base + first, base + last};
+            });
+        }
+        if (pending)
+        {
+            pool.emplace_hint(pool.cend(), *pending);
+        }
+        return pool;
+    }
+
+
+    std::uint64_t RoaringPool::addresses_count() const noexcept
+    {
+        std::uint64_t count = 0;
+        for (const auto& chunk : chunks_)
+        {
+            count += getStatistics(chunk).addresses_count;
+        }
+        return count;
+    }
+
+
+    std::size_t RoaringPool::bytes_used() const noexcept
+    {
+        std::size_t bytes = keys_.size() * sizeof(std::uint16_t);
+        for (const auto& chunk : chunks_)
+        {
+            std::visit([&bytes](const auto& contents)
+            {
+                bytes += contents.size() * sizeof(contents.front());
+            }, chunk);
+        }
+        return bytes;
+    }
+
+
+    std::optional<RoaringPool::ChunkForm> RoaringPool::chunk_form(const std::uint16_t high_half) const
+    {
+        const auto iter = std::lower_bound(keys_.cbegin(), keys_.cend(), high_half);
+        if (iter == keys_.cend() || *iter != high_half)
+        {
+            return std::nullopt;
+        }
+        return formOf(chunks_[static_cast<std::size_t>(iter - keys_.cbegin())]);
+    }
+
+
+    RoaringPool find_diff(const RoaringPool& old_pool, const RoaringPool& new_pool)
+    {
+        RoaringPool diff;
+        std::size_t new_index = 0;
+        for (std::size_t old_index = 0; old_index < old_pool.keys_.size(); ++old_index)
+        {
+            const std::uint16_t key = old_pool.keys_[old_index];
+            while (new_index < new_pool.keys_.size() && new_pool.keys_[new_index] < key)
+            {
+                ++new_index;
+            }
+
+            const auto& old_chunk = old_pool.chunks_[old_index];
+            if (new_index == new_pool.keys_.size() || new_pool.keys_[new_index] != key)
+            {
+                // Nothing is removed from the chunk, it's already in its best form
+                diff.keys_.push_back(key);
+                diff.chunks_.push_back(old_chunk);
+                continue;
+            }
+            diff.appendChunk(key, findChunkDiff(old_chunk, new_pool.chunks_[new_index]));
+        }
+        return diff;
+    }
+
+} // namespace netup_tt
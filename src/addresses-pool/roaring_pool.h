@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "ipv4_pools.h"
+
+
+namespace netup_tt
+{
+
+    // Pool in the style of roaring bitmaps, for dense pools (like whole /8 networks with lots of holes).
+    // Address space is split into chunks of 65536 addresses (/16 networks), only non-empty chunks are kept.
+    // Every chunk keeps low halves of its addresses in one of three forms, whichever is the smallest:
+    //
+    //     runs     sorted reduced ranges, 4 bytes per range       few long ranges
+    //     array    sorted addresses, 2 bytes per address          few scattered addresses
+    //     bitmap   65536 bits, always 8 KiB                       lots of short ranges and holes
+    //
+    // Diff is found chunk by chunk, with a kernel for every pair of forms (e.g. word-wise AND-NOT
+    // for two bitmaps, which compilers vectorize), and the form of every resulting chunk is chosen again.
+    class RoaringPool
+    {
+    public:
+        enum class ChunkForm
+        {
+            runs,
+            array,
+            bitmap
+        };
+
+        using ChunkRuns = std::vector<std::pair<std::uint16_t, std::uint16_t>>;
+        using ChunkArray = std::vector<std::uint16_t>;
+        // Always `chunk_words` words, bit `i % 64` of word `i / 64` is set for address `i`
+        using ChunkBitmap = std::vector<std::uint64_t>;
+        using Chunk = std::variant<ChunkRuns, ChunkArray, ChunkBitmap>;
+
+        static constexpr std::size_t chunk_words = 65536 / 64;
+
+        RoaringPool() = default;
+        explicit RoaringPool(const Pool& pool);
+
+        // Ranges of the result are reduced
+        Pool to_pool() const;
+
+        // Number of addresses in the pool
+        std::uint64_t addresses_count() const noexcept;
+        // Memory taken by chunks' contents
+        std::size_t bytes_used() const noexcept;
+        std::size_t chunks_count() const noexcept { return keys_.size(); }
+        bool empty() const noexcept { return keys_.empty(); }
+        // Form of the chunk for addresses `high_half << 16 ...`, nothing if the chunk is empty
+        std::optional<ChunkForm> chunk_form(std::uint16_t high_half) const;
+
+        bool operator==(const RoaringPool&) const = default;
+
+        friend RoaringPool find_diff(const RoaringPool& old_pool, const RoaringPool& new_pool);
+
+    private:
+        // Takes a chunk of any form (if it's not empty), converting it to the smallest one
+        void appendChunk(std::uint16_t key, Chunk&& chunk);
+
+        // High halves of addresses of chunks, in ascending order
+        std::vector<std::uint16_t> keys_;
+        std::vector<Chunk> chunks_;
+    };
+
+
+    RoaringPool find_diff(const RoaringPool& old_pool, const RoaringPool& new_pool);
+
+} // namespace netup_tt
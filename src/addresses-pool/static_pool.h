@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <stdexcept>
+
+#include "ipv4_pools.h"
+
+
+namespace netup_tt
+{
+
+    // Reduced pool of at most `Capacity` ranges in a fixed array, for tables which are known
+    // at compile time (bogons, private and reserved blocks, static ACLs). Everything is constexpr,
+    // so such tables are normalized and diffed by the compiler and get into read-only data:
+    //
+    //     constexpr StaticPool bogons(std::to_array<Range>({...}));
+    //     constexpr StaticPool allowed = find_diff(bogons, StaticPool(std::to_array<Range>({...})));
+    //     static_assert(!allowed.contains(0x7f000001));
+    //
+    // No heap is used and nothing is done at startup.
+    template <std::size_t Capacity>
+    class StaticPool
+    {
+    public:
+        using const_iterator = typename std::array<Range, Capacity>::const_iterator;
+
+        constexpr StaticPool() = default;
+
+        // Sorts and reduces `ranges`, so they may be given in any order and may intersect
+        constexpr explicit StaticPool(std::array<Range, Capacity> ranges)
+        {
+            std::sort(ranges.begin(), ranges.end());
+            auto current = ranges.cbegin();
+            while (const auto range = detail::getNextReducedRange(current, ranges.cend()))
+            {
+                ranges_[size_++] = *range;
+            }
+        }
+
+        // Takes the first `size` ranges, which are known to be reduced already
+        static constexpr StaticPool from_reduced(const std::array<Range, Capacity>& ranges, const std::size_t size)
+        {
+            assert(size <= Capacity && std::adjacent_find(
+                ranges.cbegin(),
+                ranges.cbegin() + static_cast<std::ptrdiff_t>(size),
+                [](const Range& range, const Range& next) { return !detail::isSeparated(range, next.first); }
+            ) == ranges.cbegin() + static_cast<std::ptrdiff_t>(size));
+            StaticPool pool;
+            std::copy_n(ranges.cbegin(), size, pool.ranges_.begin());
+            pool.size_ = size;
+            return pool;
+        }
+
+        // Same ranges with another capacity, e.g. to trim a result of `find_diff`:
+        //
+        //     constexpr auto trimmed = diff.with_capacity<diff.size()>();
+        template <std::size_t NewCapacity>
+        constexpr StaticPool<NewCapacity> with_capacity() const
+        {
+            if (size_ > NewCapacity)
+            {
+                throw std::invalid_argument("Ranges of static pool don't fit in new capacity");
+            }
+            std::array<Range, NewCapacity> ranges{};
+            std::copy(begin(), end(), ranges.begin());
+            return StaticPool<NewCapacity>::from_reduced(ranges, size_);
+        }
+
+        constexpr bool contains(const IPAddress address) const
+        {
+            // The first range which ends at `address` or after it
+            const auto iter = std::partition_point(begin(), end(), [address](const Range& range) { return range.second < address; });
+            return iter != end() && iter->first <= address;
+        }
+
+        Pool to_pool() const { return Pool(begin(), end()); }
+
+        constexpr std::span<const Range> ranges() const noexcept { return {ranges_.data(), size_}; }
+        constexpr std::size_t size() const noexcept { return size_; }
+        constexpr bool empty() const noexcept { return size_ == 0; }
+        constexpr const_iterator begin() const noexcept { return ranges_.cbegin(); }
+        constexpr const_iterator end() const noexcept { return ranges_.cbegin() + static_cast<std::ptrdiff_t>(size_); }
+
+        template <std::size_t OtherCapacity>
+        constexpr bool operator==(const StaticPool<OtherCapacity>& other) const
+        {
+            return std::equal(begin(), end(), other.begin(), other.end());
+        }
+
+    private:
+        // Slots after `size_` are unused
+        std::array<Range, Capacity> ranges_{};
+        std::size_t size_{0};
+    };
+
+
+    // Every range of `new_pool` cuts at most one range of `old_pool` in two,
+    // so diff has at most `OldCapacity + NewCapacity` ranges
+    template <std::size_t OldCapacity, std::size_t NewCapacity>
+    constexpr StaticPool<OldCapacity + NewCapacity> find_diff(
+        const StaticPool<OldCapacity>& old_pool,
+        const StaticPool<NewCapacity>& new_pool
+    )
+    {
+        std::array<Range, OldCapacity + NewCapacity> diff{};
+        std::size_t size = 0;
+        detail::findDiff(
+            detail::PlainRangesReader(old_pool.begin(), old_pool.end()),
+            detail::PlainRangesReader(new_pool.begin(), new_pool.end()),
+            [&diff, &size](const IPAddress first, const IPAddress last) { diff[size++] = Range{first, last}; }
+        );
+        return StaticPool<OldCapacity + NewCapacity>::from_reduced(diff, size);
+    }
+
+} // namespace netup_tt
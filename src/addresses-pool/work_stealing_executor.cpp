@@ -0,0 +1,194 @@
+#include "work_stealing_executor.h"
+
+#include <cstdint>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace netup_tt
+{
+
+    namespace
+    {
+
+        // Block [begin, end) of task indexes, packed into one word, so that the owner
+        // and thieves take indexes by compare-and-swap without locks
+        class alignas(64) TasksBlock
+        {
+        public:
+            void assign(const std::uint32_t begin, const std::uint32_t end) noexcept
+            {
+                bounds_.store(pack(begin, end), std::memory_order_release);
+            }
+
+            std::uint32_t size() const noexcept
+            {
+                const auto [begin, end] = unpack(bounds_.load(std::memory_order_relaxed));
+                return end - begin;
+            }
+
+            // Takes the first index, for the owner
+            std::optional<std::uint32_t> pop() noexcept
+            {
+                std::uint64_t bounds = bounds_.load(std::memory_order_acquire);
+                while (true)
+                {
+                    const auto [begin, end] = unpack(bounds);
+                    if (begin == end)
+                    {
+                        return std::nullopt;
+                    }
+                    if (bounds_.compare_exchange_weak(bounds, pack(begin + 1, end), std::memory_order_acq_rel))
+                    {
+                        return begin;
+                    }
+                }
+            }
+
+            // Takes the back half (rounded up), for thieves
+            std::optional<std::pair<std::uint32_t, std::uint32_t>> steal() noexcept
+            {
+                std::uint64_t bounds = bounds_.load(std::memory_order_acquire);
+                while (true)
+                {
+                    const auto [begin, end] = unpack(bounds);
+                    if (begin == end)
+                    {
+                        return std::nullopt;
+                    }
+                    const std::uint32_t middle = begin + (end - begin) / 2;
+                    if (bounds_.compare_exchange_weak(bounds, pack(begin, middle), std::memory_order_acq_rel))
+                    {
+                        return std::pair{middle, end};
+                    }
+                }
+            }
+
+        private:
+            static std::uint64_t pack(const std::uint32_t begin, const std::uint32_t end) noexcept
+            {
+                return std::uint64_t{end} << 32 | begin;
+            }
+
+            static std::pair<std::uint32_t, std::uint32_t> unpack(const std::uint64_t bounds) noexcept
+            {
+                return {static_cast<std::uint32_t>(bounds), static_cast<std::uint32_t>(bounds >> 32)};
+            }
+
+            std::atomic<std::uint64_t> bounds_{0};
+        };
+
+
+        void runWithWorkStealing(
+            const std::size_t threads_count,
+            const std::size_t tasks_count,
+            const std::function<void(std::size_t)>& task
+        )
+        {
+            if (tasks_count > std::numeric_limits<std::uint32_t>::max())
+            {
+                throw std::invalid_argument("Work stealing executor: too many tasks");
+            }
+            const std::size_t workers_count = std::max<std::size_t>(1, std::min(threads_count, tasks_count));
+
+            std::vector<TasksBlock> blocks(workers_count);
+            for (std::size_t worker = 0; worker < workers_count; ++worker)
+            {
+                blocks[worker].assign(
+                    static_cast<std::uint32_t>(worker * tasks_count / workers_count),
+                    static_cast<std::uint32_t>((worker + 1) * tasks_count / workers_count)
+                );
+            }
+
+            std::vector<std::exception_ptr> errors(tasks_count);
+            const auto run_task = [&task, &errors](const std::size_t index)
+            {
+                try
+                {
+                    task(index);
+                }
+                catch (...)
+                {
+                    errors[index] = std::current_exception();
+                }
+            };
+
+            const auto work = [&blocks, &run_task](const std::size_t worker)
+            {
+                auto& own_block = blocks[worker];
+                while (true)
+                {
+                    if (const auto index = own_block.pop())
+                    {
+                        run_task(*index);
+                        continue;
+                    }
+
+                    // The biggest block is the one most likely to be left behind
+                    TasksBlock* victim = nullptr;
+                    std::uint32_t victim_size = 0;
+                    for (auto& block : blocks)
+                    {
+                        if (const std::uint32_t size = block.size(); size > victim_size)
+                        {
+                            victim = &block;
+                            victim_size = size;
+                        }
+                    }
+                    if (victim == nullptr)
+                    {
+                        // Tasks which are still stolen but not put into their new blocks
+                        // are run by their thieves
+                        return;
+                    }
+                    if (const auto stolen = victim->steal())
+                    {
+                        own_block.assign(stolen->first + 1, stolen->second);
+                        run_task(stolen->first);
+                    }
+                }
+            };
+
+            {
+                std::vector<std::jthread> threads;
+                threads.reserve(workers_count - 1);
+                for (std::size_t worker = 1; worker < workers_count; ++worker)
+                {
+                    threads.emplace_back(work, worker);
+                }
+                work(0);
+            }
+
+            for (const auto& error : errors)
+            {
+                if (error)
+                {
+                    std::rethrow_exception(error);
+                }
+            }
+        }
+
+    } // anonymous namespace
+
+
+    ParallelExecutor make_work_stealing_executor(std::size_t threads_count)
+    {
+        if (threads_count == 0)
+        {
+            threads_count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        return [threads_count](const std::size_t tasks_count, const std::function<void(std::size_t)>& task)
+        {
+            runWithWorkStealing(threads_count, tasks_count, task);
+        };
+    }
+
+} // namespace netup_tt
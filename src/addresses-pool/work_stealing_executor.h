@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+#include "parallel_diff.h"
+
+
+namespace netup_tt
+{
+
+    // Executor which spreads tasks over `threads_count` threads (0 means `std::thread::hardware_concurrency()`)
+    // with work stealing. Every thread gets an equal block of task indexes and takes them from the front;
+    // a thread which has run out of its own tasks steals the back half of the biggest remaining block
+    // of another thread. So tasks of very different costs (like diffs with pools of different sizes)
+    // are balanced without a shared queue which every thread would touch for every task.
+    //
+    //     start                          thread 0  [0 1 2 3]    thread 1  [4 5 6 7]
+    //     thread 1 is still running 4    thread 0  [ ]          thread 1  [5 6 7]
+    //     thread 0 steals the back half  thread 0  [6 7]        thread 1  [5]
+    //
+    // The calling thread is one of the workers. If tasks throw, the first exception (by task index)
+    // is rethrown after all tasks are finished.
+    ParallelExecutor make_work_stealing_executor(std::size_t threads_count = 0);
+
+} // namespace netup_tt